@@ -28,7 +28,12 @@
 #include <condition_variable>
 #include <tdap/Allocation.hpp>
 #include <tdap/MemoryFence.hpp>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <string>
 #include <sys/mman.h>
+#include <unistd.h>
 
 
 namespace tdap {
@@ -47,35 +52,125 @@ namespace tdap {
         static Handle *linked_;
         static Mutex linked_mutex_;
 
+        /**
+         * The block is mapped anonymously instead of allocated, so that it is
+         * page aligned, can be backed by huge pages and is pre-faulted. The
+         * real-time thread strides across tens of megabytes of history and
+         * with huge pages that needs far fewer TLB entries. Pre-faulting
+         * happens on the creating thread, so with the default first-touch
+         * policy the pages are placed on the NUMA node that thread runs on.
+         * A block that is only used to measure what is allocated is not
+         * pre-faulted, so that it can be large without using memory.
+         */
         struct Block
         {
+            enum class Pages { HUGETLB, TRANSPARENT_HUGE, NORMAL, ON_DEMAND };
+            static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
             char * data_start_;
             char * alloc_start_;
-            Block(size_t block_size)
+            size_t mapped_size_;
+            Pages pages_;
+
+            Block(size_t block_size, bool populate) :
+                mapped_size_(roundup(block_size, HUGE_PAGE_SIZE))
             {
-                char * result = static_cast<char *>(malloc(block_size));
-                if (result == nullptr) {
-                    throw std::bad_alloc();
+                if (!populate) {
+                    // Only the pages that are used get memory
+                    void *result = mmap(nullptr, mapped_size_,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                        -1, 0);
+                    if (result == MAP_FAILED) {
+                        throw std::bad_alloc();
+                    }
+                    pages_ = Pages::ON_DEMAND;
+                    alloc_start_ = data_start_ = static_cast<char *>(result);
+                    return;
                 }
-                size_t alignment = sizeof(max_align_t);
-                char *null_ptr = (char *)nullptr;
+                void *result = mmap(nullptr, mapped_size_,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                                    -1, 0);
+                if (result != MAP_FAILED) {
+                    pages_ = Pages::HUGETLB;
+                }
+                else {
+                    // No reserved huge pages: ask for transparent ones
+                    result = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (result == MAP_FAILED) {
+                        throw std::bad_alloc();
+                    }
+                    pages_ = madvise(result, mapped_size_, MADV_HUGEPAGE) == 0
+                             ? Pages::TRANSPARENT_HUGE
+                             : Pages::NORMAL;
+                    prefault(static_cast<char *>(result), mapped_size_);
+                }
+                alloc_start_ = data_start_ = static_cast<char *>(result);
+            }
 
-                if ((result - null_ptr) % alignment == 0) {
-                    alloc_start_ = data_start_ = result;
-                    return;
+            void release() const
+            {
+                munmap(data_start_, mapped_size_);
+            }
+
+            /**
+             * Writes to each page, as MAP_POPULATE before madvise() would have
+             * faulted the block in with normal pages.
+             */
+            static void prefault(char *start, size_t size)
+            {
+                const size_t page_size = sysconf(_SC_PAGESIZE);
+                for (size_t offset = 0; offset < size; offset += page_size) {
+                    static_cast<volatile char *>(start)[offset] = 0;
                 }
-                char * new_result = static_cast<char *>(realloc(result, block_size +
-                                                                        alignment));
-                if (new_result == nullptr) {
-                    free(result);
-                    throw std::bad_alloc();
+            }
+
+            /**
+             * Returns the number of bytes in the block that are backed by
+             * huge pages, as reported by the kernel.
+             */
+            size_t huge_page_bytes() const
+            {
+                if (pages_ == Pages::HUGETLB) {
+                    return mapped_size_;
                 }
-                data_start_ = new_result;
-                alloc_start_ = null_ptr + alignment * (1 + ((data_start_ - null_ptr) - 1) / alignment);
-//                cout << "Allocated aligned block: data=" << (void*)data_start_ << "; alloc_start=" << (void*)alloc_start_ << endl;
+                ifstream smaps("/proc/self/smaps");
+                string line;
+                bool in_block = false;
+                size_t result = 0;
+                const uintptr_t start = reinterpret_cast<uintptr_t>(data_start_);
+                const uintptr_t end = start + mapped_size_;
+                while (getline(smaps, line)) {
+                    uintptr_t from;
+                    uintptr_t to;
+                    if (sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &from, &to) == 2) {
+                        in_block = from < end && to > start;
+                        continue;
+                    }
+                    size_t kilobytes;
+                    if (in_block && sscanf(line.c_str(), "AnonHugePages: %zu kB", &kilobytes) == 1) {
+                        result += kilobytes * 1024;
+                    }
+                }
+                return result;
             }
-        };
 
+            const char *pages_name() const
+            {
+                switch (pages_) {
+                case Pages::HUGETLB:
+                    return "hugetlb";
+                case Pages::TRANSPARENT_HUGE:
+                    return "transparent huge pages";
+                case Pages::ON_DEMAND:
+                    return "pages on demand";
+                default:
+                    return "normal pages";
+                }
+            }
+        };
 
         const Block data_;
         char * const alloc_end_;
@@ -96,11 +191,11 @@ namespace tdap {
             return Lock(mutex_);
         }
 
-        static void * default_alloc(size_t size, bool aligned)
+        static void * default_alloc(size_t size, size_t alignment)
         {
             void *result;
-            if (size && aligned) {
-                result = aligned_alloc(size, size);
+            if (size && alignment > sizeof(max_align_t)) {
+                result = aligned_alloc(alignment, roundup(size, alignment));
             }
             else {
                 result = malloc(size);
@@ -108,7 +203,7 @@ namespace tdap {
             if (result == nullptr) {
                 throw std::bad_alloc();
             }
-//            cout << "default_alloc(" << size << ", " << aligned << "): " << result << endl;
+//            cout << "default_alloc(" << size << ", " << alignment << "): " << result << endl;
             return result;
         }
 
@@ -117,36 +212,36 @@ namespace tdap {
             return alignment * (1 + (value - 1) / alignment);
         }
 
-        char * get_this_and_next_alloc(size_t size, bool aligned, char *&next_alloc) const
+        char * get_this_and_next_alloc(size_t size, size_t alignment, char *&next_alloc) const
         {
             size_t fundamental_alignment = sizeof(max_align_t);
             size_t rounded_size = roundup(size, fundamental_alignment);
-            if (aligned) {
-                size_t alloc_start_value = data_.alloc_start_ - (char *) nullptr;
-                size_t alloc_value = roundup(next_alloc_ - (char *) nullptr, rounded_size) - alloc_start_value;
-                char * result = data_.alloc_start_ + alloc_value;
-                next_alloc = result + rounded_size;
+            char *result = next_alloc_;
+            if (alignment > fundamental_alignment) {
+                // The block start is page aligned, so offsets can be aligned
+                size_t offset = next_alloc_ - data_.alloc_start_;
+                result = data_.alloc_start_ + (offset + alignment - 1) / alignment * alignment;
             }
-            next_alloc = next_alloc_ + rounded_size;
-            return next_alloc_;
+            next_alloc = result + rounded_size;
+            return result;
         }
 
-        void * allocate(size_t size, bool aligned)
+        void * allocate(size_t size, size_t alignment)
         {
             Lock lock(mutex_);
             char *next_alloc;
-            char *this_alloc = get_this_and_next_alloc(size, aligned, next_alloc);
+            char *this_alloc = get_this_and_next_alloc(size, alignment, next_alloc);
             bool shouldAllocate = state_ == State::ENABLED && thread_id_ == this_thread::get_id();
             if (!shouldAllocate) {
-                return default_alloc(size, aligned);
+                return default_alloc(size, alignment);
             }
             if (next_alloc <= alloc_end_) {
                 next_alloc_ = next_alloc;
-//                cout << "consecutive_alloc(" << size << ", " << aligned << "): " << (void *)this_alloc << endl;
+//                cout << "consecutive_alloc(" << size << ", " << alignment << "): " << (void *)this_alloc << endl;
                 allocations_++;
                 return this_alloc;
             }
-            void *result = default_alloc(size, aligned);
+            void *result = default_alloc(size, alignment);
             if (next_alloc_ < alloc_end_) {
                 cerr << "consecutive_alloc() created split; next_alloc=" << (next_alloc_ - data_.alloc_start_) << ";alloc_end=" << (alloc_end_ - data_.alloc_start_) << endl;
             }
@@ -231,8 +326,8 @@ namespace tdap {
         static Handle * thread_handle() { return thread_handle_; }
 
 
-        Handle(size_t block_size) :
-            data_(block_size),
+        Handle(size_t block_size, bool prefault) :
+            data_(block_size, prefault),
             alloc_end_(data_.alloc_start_ + block_size),
             next_alloc_(data_.alloc_start_),
             owner_(nullptr),
@@ -248,6 +343,8 @@ namespace tdap {
                 throw runtime_error("Alignment criterium failed");
             }
 //            cout << "Created handle " << this << "; data=" << (void *)data_.data_start_ << "; alloc=" << (void *)data_.alloc_start_ << "; end=" << (void *)alloc_end_ << "; size=" << block_size << endl;
+            cout << "Consecutive block of " << block_size << " bytes with " << data_.pages_name()
+                 << ": " << data_.huge_page_bytes() << " of " << data_.mapped_size_ << " bytes in huge pages" << endl;
             link_handle(this);
         }
 
@@ -356,12 +453,12 @@ namespace tdap {
             return disable_consecutive_allocation_ == 1;
         }
 
-        static void * allocate_static(size_t size, bool aligned)
+        static void * allocate_static(size_t size, size_t alignment)
         {
             if (disable_consecutive_allocation_ > 0 || thread_handle_ == nullptr) {
-                return default_alloc(size, aligned);
+                return default_alloc(size, alignment);
             }
-            return thread_handle_->allocate(size, aligned);
+            return thread_handle_->allocate(size, alignment);
         }
 
         static void free_static(void *data)
@@ -399,7 +496,7 @@ namespace tdap {
                 munlock(data_.alloc_start_, alloc_end_ - data_.alloc_start_);
                 locked_memory_ = false;
             }
-            free(data_.data_start_);
+            data_.release();
 //            cerr << this << ": closed" << endl;
             state_ = State::CLOSED;
         }
@@ -507,9 +604,9 @@ namespace tdap {
                 "Error in function with (consecutive_block_handle_t *): handle=nullptr");
     }
 
-    consecutive_block_handle_t* consecutive_alloc::construct_with_size(size_t block_size)
+    consecutive_block_handle_t* consecutive_alloc::construct_with_size(size_t block_size, bool prefault)
     {
-        Handle *handle = new Handle(block_size);
+        Handle *handle = new Handle(block_size, prefault);
 //        cout << endl << "- new handle=" << handle << "; for size " << block_size << endl;
         return handle;
     }
@@ -631,12 +728,12 @@ namespace tdap {
 
 void* operator new  ( std::size_t count )
 {
-    return tdap::Handle::allocate_static(count, false);
+    return tdap::Handle::allocate_static(count, 0);
 }
 
-void* operator new  ( std::size_t count, std::align_val_t )
+void* operator new  ( std::size_t count, std::align_val_t alignment )
 {
-    return tdap::Handle::allocate_static(count, true);
+    return tdap::Handle::allocate_static(count, static_cast<size_t>(alignment));
 }
 
 void operator delete  ( void* ptr ) noexcept
@@ -10,6 +10,7 @@ const DetectionConfig DetectionConfig::unsetConfig() {
   DetectionConfig result;
 
   unsetConfigValue(result.useBrickWallPrediction);
+  unsetConfigValue(result.useTruePeak);
   unsetConfigValue(result.maximum_window_seconds);
   unsetConfigValue(result.minimum_window_seconds);
   unsetConfigValue(result.rms_fast_release_seconds);
@@ -22,6 +23,7 @@ void DetectionConfig::set_if_unset(const DetectionConfig &config_if_unset) {
   int &value = useBrickWallPrediction;
   bool result;
   result = setConfigValueIfUnset(value, config_if_unset.useBrickWallPrediction);
+  setConfigValueIfUnset(useTruePeak, config_if_unset.useTruePeak);
   fixedValueIfUnsetOrBoxedIfOutOfRange(
       maximum_window_seconds, config_if_unset.maximum_window_seconds,
       MIN_MAXIMUM_WINDOW_SECONDS, MAX_MAXIMUM_WINDOW_SECONDS);
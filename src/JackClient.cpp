@@ -300,6 +300,14 @@ ClientState JackClient::getState() {
   return state_;
 }
 
+jack_nframes_t JackClient::getSampleRate() {
+  unique_lock<mutex> lock(mutex_);
+  if (state_ == ClientState::CLOSED) {
+    throw runtime_error("getSampleRate: in CLOSED state");
+  }
+  return jack_get_sample_rate(client_);
+}
+
 void JackClient::notifyShutdown(const char *reason) {
   onShutdown(ShutDownInfo::withReason(reason));
 }
@@ -33,6 +33,38 @@ namespace speakerman::jack {
 using namespace std;
 using namespace tdap;
 
+namespace {
+
+/**
+ * Keeps processing suspended while metrics are updated. Processing that was
+ * running is always resumed, also when the update fails or throws.
+ */
+class SuspendProcessing {
+  std::atomic_flag &running_;
+  bool resume_ = false;
+
+public:
+  explicit SuspendProcessing(std::atomic_flag &running) : running_(running) {}
+
+  // Waits for the current cycle and keeps later ones out
+  void awaitCycle() {
+    while (running_.test_and_set()) {
+      std::this_thread::yield();
+    }
+    resume_ = true;
+  }
+
+  void resumeOnExit() { resume_ = true; }
+
+  ~SuspendProcessing() {
+    if (resume_) {
+      running_.clear();
+    }
+  }
+};
+
+} // namespace
+
 JackProcessor::Reset::Reset(JackProcessor *owner) : owner_(owner) {}
 
 JackProcessor::Reset::~Reset() { owner_->unsafeResetState(); }
@@ -136,12 +168,17 @@ bool JackProcessor::updateMetrics(jack_client_t *client,
       needsBufferSize() ? update.bufferSize : 0};
 
   if (rateConditionMet && bufferSizeConditionMet) {
+    onPrepareMetrics(relevantMetrics);
+    SuspendProcessing suspend(running_);
+    if (!(metrics_ == ProcessingMetrics::withRate(0).withBufferSize(0))) {
+      suspend.awaitCycle();
+    }
     if (onMetricsUpdate(relevantMetrics)) {
       if (metrics_ == ProcessingMetrics::withRate(0).withBufferSize(0)) {
         ensurePorts(client);
       }
       metrics_ = relevantMetrics;
-      running_.clear();
+      suspend.resumeOnExit();
       statistics.setSampleRate(metrics_.sampleRate);
       return true;
     }
@@ -0,0 +1,188 @@
+/*
+ * speakerman/LevelHistory.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <speakerman/LevelHistory.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace speakerman {
+
+/**
+ * Identifies the layout of a history file, so that a file with a different
+ * layout is reset instead of misread.
+ */
+struct LevelHistory::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t bucketBytes;
+  uint32_t maxLevels;
+  uint32_t secondBuckets;
+  uint32_t minuteBuckets;
+  uint32_t reserved;
+
+  static Header current() {
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, "SPKHIST", 8);
+    header.version = 1;
+    header.bucketBytes = sizeof(LevelHistoryBucket);
+    header.maxLevels = LevelHistoryBucket::MAX_LEVELS;
+    header.secondBuckets = SECOND_BUCKETS;
+    header.minuteBuckets = MINUTE_BUCKETS;
+    return header;
+  }
+};
+
+size_t LevelHistory::historyBytes() {
+  return sizeof(Header) +
+         (SECOND_BUCKETS + MINUTE_BUCKETS) * sizeof(LevelHistoryBucket);
+}
+
+void LevelHistoryBucket::add(int64_t bucketStart,
+                             const DynamicProcessorLevels &values) {
+  size_t count = std::min(values.groups() + 1, MAX_LEVELS);
+  if (start != bucketStart || levels != count) {
+    start = bucketStart;
+    samples = 1;
+    levels = count;
+    for (size_t i = 0; i < count; i++) {
+      level[i].start(values.getSignal(i));
+      peak[i].start(values.getPeak(i));
+      gain[i].start(values.getGain(i));
+    }
+    return;
+  }
+  samples++;
+  for (size_t i = 0; i < count; i++) {
+    level[i].add(values.getSignal(i));
+    peak[i].add(values.getPeak(i));
+    gain[i].add(values.getGain(i));
+  }
+}
+
+LevelHistory::LevelHistory(const char *fileName) {
+  if (fileName != nullptr && mapFile(fileName)) {
+    persistent_ = true;
+  } else if (!mapMemory()) {
+    throw std::bad_alloc();
+  }
+  auto *buckets = reinterpret_cast<LevelHistoryBucket *>(
+      static_cast<char *>(mapping_) + sizeof(Header));
+  seconds_ = buckets;
+  minutes_ = buckets + SECOND_BUCKETS;
+}
+
+LevelHistory::~LevelHistory() {
+  if (mapping_) {
+    munmap(mapping_, mappingBytes_);
+  }
+}
+
+bool LevelHistory::mapFile(const char *fileName) {
+  int fd = open(fileName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    std::cerr << "Cannot open level history " << fileName << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  Header expected = Header::current();
+  Header found;
+  struct stat status;
+  bool valid = fstat(fd, &status) == 0 &&
+               size_t(status.st_size) == historyBytes() &&
+               pread(fd, &found, sizeof(Header), 0) == sizeof(Header) &&
+               memcmp(&found, &expected, sizeof(Header)) == 0;
+  if (!valid) {
+    // Discard history with another layout
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, historyBytes()) != 0 ||
+        pwrite(fd, &expected, sizeof(Header), 0) != sizeof(Header)) {
+      std::cerr << "Cannot initialize level history " << fileName << ": "
+                << strerror(errno) << std::endl;
+      close(fd);
+      return false;
+    }
+  }
+  void *mapping = mmap(nullptr, historyBytes(), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "Cannot map level history " << fileName << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  mapping_ = mapping;
+  mappingBytes_ = historyBytes();
+  std::cout << (valid ? "Continuing" : "Started") << " level history in "
+            << fileName << std::endl;
+  return true;
+}
+
+bool LevelHistory::mapMemory() {
+  void *mapping = mmap(nullptr, historyBytes(), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  mapping_ = mapping;
+  mappingBytes_ = historyBytes();
+  return true;
+}
+
+void LevelHistory::add(long long stamp, const DynamicProcessorLevels &levels) {
+  int64_t second = stamp / 1000;
+  int64_t minute = second / 60;
+  std::unique_lock<std::mutex> lock(m);
+  seconds_[second % SECOND_BUCKETS].add(second, levels);
+  minutes_[minute % MINUTE_BUCKETS].add(minute * 60, levels);
+}
+
+void LevelHistory::query(int64_t from, int64_t to, Resolution resolution,
+                         std::vector<LevelHistoryBucket> &output) {
+  output.clear();
+  size_t size =
+      resolution == Resolution::Seconds ? SECOND_BUCKETS : MINUTE_BUCKETS;
+  const LevelHistoryBucket *buckets =
+      resolution == Resolution::Seconds ? seconds_ : minutes_;
+  {
+    std::unique_lock<std::mutex> lock(m);
+    for (size_t i = 0; i < size; i++) {
+      const LevelHistoryBucket &bucket = buckets[i];
+      if (bucket.samples > 0 && bucket.start >= from && bucket.start <= to) {
+        output.push_back(bucket);
+      }
+    }
+  }
+  // Buckets are in time order, except around the slot that is written now
+  // and after the clock was changed.
+  std::sort(output.begin(), output.end(),
+            [](const LevelHistoryBucket &b1, const LevelHistoryBucket &b2) {
+              return b1.start < b2.start;
+            });
+}
+
+} // namespace speakerman
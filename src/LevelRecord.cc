@@ -0,0 +1,119 @@
+/*
+ * speakerman/LevelRecord.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <speakerman/LevelRecord.h>
+
+namespace speakerman {
+
+namespace {
+
+void putLittleEndian(uint8_t *destination, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; i++) {
+    destination[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+void putFloat(uint8_t *destination, double value) {
+  putLittleEndian(destination, std::bit_cast<uint32_t>(float(value)), 4);
+}
+
+} // namespace
+
+void LevelRecord::set(uint64_t sequence, long long stamp,
+                      const DynamicProcessorLevels &levels,
+                      double thresholdScale, double cpuLongTerm,
+                      double cpuShortTerm) {
+  memset(bytes, 0, BYTES);
+  size_t count = std::min(levels.groups() + 1, MAX_LEVELS);
+  putLittleEndian(bytes, sequence, 8);
+  putLittleEndian(bytes + 8, static_cast<uint64_t>(stamp), 8);
+  putLittleEndian(bytes + 16, levels.count(), 4);
+  putLittleEndian(bytes + 20, count, 2);
+  putFloat(bytes + 24, thresholdScale);
+  putFloat(bytes + 28, cpuLongTerm);
+  putFloat(bytes + 32, cpuShortTerm);
+  for (size_t i = 0; i < count; i++) {
+    uint8_t *level = bytes + HEADER_BYTES + i * LEVEL_BYTES;
+    putFloat(level, levels.getSignal(i));
+    putFloat(level + 4, levels.getPeak(i));
+    putFloat(level + 8, levels.getGain(i));
+  }
+}
+
+uint64_t LevelRecord::sequence() const {
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; i++) {
+    value |= uint64_t(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+void LevelRecordRing::put(const LevelRecord &record) {
+  uint64_t sequence = record.sequence();
+  std::unique_lock<std::mutex> lock(m);
+  records[sequence % SIZE] = record;
+  latest_ = sequence;
+}
+
+size_t LevelRecordRing::writeSince(uint64_t sequence, std::string &output) {
+  std::unique_lock<std::mutex> lock(m);
+  if (sequence > latest_) {
+    // The client saw records of an earlier run
+    return write(latest_, output);
+  }
+  return write(sequence + 1, output);
+}
+
+size_t LevelRecordRing::writeLatest(std::string &output) {
+  std::unique_lock<std::mutex> lock(m);
+  return write(latest_, output);
+}
+
+size_t LevelRecordRing::write(uint64_t first, std::string &output) {
+  if (latest_ >= SIZE) {
+    first = std::max(first, latest_ - SIZE + 1);
+  }
+  first = std::max(first, uint64_t(1));
+
+  output.assign(REPLY_HEADER_BYTES, '\0');
+  uint8_t *header = reinterpret_cast<uint8_t *>(output.data());
+  memcpy(header, "SPKL", 4);
+  putLittleEndian(header + 4, VERSION, 2);
+  putLittleEndian(header + 6, LevelRecord::BYTES, 2);
+  putLittleEndian(header + 12, LevelRecord::MAX_LEVELS, 2);
+
+  size_t count = 0;
+  for (uint64_t sequence = first; sequence <= latest_; sequence++) {
+    const LevelRecord &record = records[sequence % SIZE];
+    if (record.sequence() == sequence) {
+      output.append(reinterpret_cast<const char *>(record.bytes),
+                    LevelRecord::BYTES);
+      count++;
+    }
+  }
+  putLittleEndian(reinterpret_cast<uint8_t *>(output.data()) + 8, count, 4);
+  return count;
+}
+
+} // namespace speakerman
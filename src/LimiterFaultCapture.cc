@@ -0,0 +1,20 @@
+//
+// Created by michel on 18-10-26.
+//
+#include <speakerman/LimiterFaultCapture.h>
+
+namespace speakerman {
+
+void LimiterFaultSnapshot::writeCsv(std::ostream &out) const {
+  out << "# limiter=" << limiter << "; sample-rate=" << sampleRate
+      << "; threshold=" << threshold << "; latency=" << latency
+      << "; fault-sample=" << faultSample << "\n";
+  out << "sample,peak,gain,output\n";
+  long long relative = -static_cast<long long>(PRE_SAMPLES - 1);
+  for (size_t i = 0; i < SAMPLES; i++, relative++) {
+    out << relative << ',' << entry[i].peak << ',' << entry[i].gain << ','
+        << entry[i].output << '\n';
+  }
+}
+
+} // namespace speakerman
@@ -26,6 +26,7 @@
 #include <speakerman/SpeakermanConfig.hpp>
 #include <speakerman/SpeakermanWebServer.hpp>
 #include <unistd.h>
+#include <zlib.h>
 
 namespace speakerman {
 
@@ -48,15 +49,45 @@ static void reallocate(char *&buffer, size_t &capacity, size_t size) {
     if (size <= capacity) {
       return;
     }
-    char *newBuffer = new char[size];
     delete[] buffer;
-    buffer = newBuffer;
-    capacity = size;
   }
   buffer = new char[size];
   capacity = size;
 }
 
+static string createETag(const char *data, size_t size) {
+  // 64-bit FNV-1a
+  uint64_t hash = 0xcbf29ce484222325;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3;
+  }
+  char etag[40];
+  snprintf(etag, sizeof(etag), "\"%016llx-%zx\"", (unsigned long long)hash,
+           size);
+  return etag;
+}
+
+static void gzip(const char *data, size_t size, string &target) {
+  target.clear();
+  z_stream stream{};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return;
+  }
+  target.resize(deflateBound(&stream, size));
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+  stream.avail_in = size;
+  stream.next_out = reinterpret_cast<Bytef *>(target.data());
+  stream.avail_out = target.size();
+  if (deflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out < size) {
+    target.resize(stream.total_out);
+  } else {
+    target.clear();
+  }
+  deflateEnd(&stream);
+}
+
 class file_ptr_owner {
   FILE *file_;
 
@@ -78,6 +109,9 @@ public:
 file_entry::file_entry(const char *name)
     : name_(createFileName(name)), fileStamp_(0), lastChecked_(0) {}
 
+file_entry::file_entry(const char *directory, const char *name)
+    : name_(string(directory) + "/" + name), fileStamp_(0), lastChecked_(0) {}
+
 void file_entry::reset() {
   readPos_ = 0;
   long long now = current_millis();
@@ -85,6 +119,7 @@ void file_entry::reset() {
   if (notCheckedFor > -1000 && notCheckedFor < 1000) {
     return;
   }
+  lastChecked_ = now;
   if (access(name_.c_str(), F_OK) != 0) {
     return;
   }
@@ -94,6 +129,9 @@ void file_entry::reset() {
   }
   std::cout << "I: Reading " << name_ << std::endl;
   file_ptr_owner f = fopen(name_.c_str(), "rb");
+  if (!f) {
+    return;
+  }
   if (fseek(f, 0, SEEK_END) != 0) {
     return;
   }
@@ -105,7 +143,7 @@ void file_entry::reset() {
   size_ = 0;
   size_t totalReads = 0;
   int attempt = 0;
-  while (attempt < 10 && totalReads < size) {
+  while (attempt++ < 10 && totalReads < size) {
     long long toRead = size - totalReads;
     if (toRead <= 0) {
       break;
@@ -120,6 +158,25 @@ void file_entry::reset() {
   }
   size_ = totalReads;
   fileStamp_ = fileStamp;
+  etag_ = createETag(data_, size_);
+  gzip(data_, size_, gzipped_);
+}
+
+const char *file_entry::contentType() const {
+  const char *extension = strrchr(name_.c_str(), '.');
+  if (extension == nullptr) {
+    return "application/octet-stream";
+  }
+  if (strcmp(extension, ".html") == 0) {
+    return "text/html; charset=UTF-8";
+  }
+  if (strcmp(extension, ".js") == 0) {
+    return "text/javascript; charset=UTF-8";
+  }
+  if (strcmp(extension, ".css") == 0) {
+    return "text/css; charset=UTF-8";
+  }
+  return "application/octet-stream";
 }
 
 signed long file_entry::read(void *buff, size_t offs, size_t length) {
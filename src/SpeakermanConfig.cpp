@@ -59,6 +59,8 @@ static constexpr const char *DETECTION_CONFIG_KEY_RMS_FAST_RELEASE_SECONDS =
     "detection.rms-fast-release-seconds";
 static constexpr const char *DETECTION_CONFIG_KEY_USE_BRICK_WALL_PREDICTION =
     "detection.use-brick-wall-prediction";
+static constexpr const char *DETECTION_CONFIG_KEY_USE_TRUE_PEAK =
+    "detection.true-peak";
 static constexpr const char *EQ_CONFIG_KEY_EQUALIZER = "equalizer";
 static constexpr const char *EQ_CONFIG_KEY_CENTER = "center";
 static constexpr const char *EQ_CONFIG_KEY_GAIN = "gain";
@@ -95,6 +97,8 @@ static constexpr const char *SPEAKER_MANAGER_CONFIG_KEY_CROSSOVERS =
     *SPEAKER_MANAGER_CONFIG_KEY_INPUT_COUNT = "input-count";
 static constexpr const char *SPEAKER_MANAGER_CONFIG_KEY_GENERATE_NOISE =
     "generate-noise";
+static constexpr const char *SPEAKER_MANAGER_CONFIG_KEY_LEVEL_STREAM_MILLIS =
+    "level-stream-millis";
 
 } // anonymous namespace
 
@@ -664,6 +668,8 @@ public:
     add_reader(SPEAKER_MANAGER_CONFIG_KEY_SUB_OUTPUT, false, subOutput);
 
     add_reader(SPEAKER_MANAGER_CONFIG_KEY_GENERATE_NOISE, true, generateNoise);
+    add_reader(SPEAKER_MANAGER_CONFIG_KEY_LEVEL_STREAM_MILLIS, false,
+               levelStreamMillis);
 
     add_reader(DETECTION_CONFIG_KEY_MAXIMUM_WINDOW_SECONDS, false,
                detection.maximum_window_seconds);
@@ -675,6 +681,8 @@ public:
                detection.perceptive_levels);
     add_reader(DETECTION_CONFIG_KEY_USE_BRICK_WALL_PREDICTION, false,
                detection.useBrickWallPrediction);
+    add_reader(DETECTION_CONFIG_KEY_USE_TRUE_PEAK, false,
+               detection.useTruePeak);
 
     addLogicalGroups(logicalInputs, LOGICAL_GROUP_CONFIG_KEY_INPUT);
     // Disabled outputs for now, as we are not going to use them
@@ -989,22 +997,17 @@ const char *configFileName() {
   return name.c_str();
 }
 
-static string internalGetWatchDogScript() {
-  string watchDog = getInstallBaseDirectory();
-  watchDog += "share/speakerman/script/speakerman-watchdog.sh";
+static string getLevelHistoryFileName() {
+  string historyFileName = std::getenv("HOME");
+  historyFileName += "/.config/speakerman/level-history.bin";
 
-  if (access(watchDog.c_str(), F_OK) == 0) {
-    cout << "Watch-dog script: " << watchDog << endl;
-    return watchDog;
-  }
-
-  return "";
+  return historyFileName;
 }
 
-const char *getWatchDogScript() {
-  static string script = internalGetWatchDogScript();
+const char *levelHistoryFileName() {
+  static string name = getLevelHistoryFileName();
 
-  return script.length() > 0 ? script.c_str() : nullptr;
+  return name.c_str();
 }
 
 static void resetStream(istream &stream) {
@@ -1166,6 +1169,7 @@ const SpeakermanConfig SpeakermanConfig::unsetConfig() {
   unsetConfigValue(result.relativeSubThreshold);
   unsetConfigValue(result.subDelay);
   unsetConfigValue(result.generateNoise);
+  unsetConfigValue(result.levelStreamMillis);
   unsetConfigValue(result.eqs);
   result.timeStamp = -1;
 
@@ -1220,6 +1224,9 @@ void SpeakermanConfig::setInitial() {
                                      MIN_SUB_DELAY, MAX_SUB_DELAY);
   setDefaultOrBoxedFromSourceIfUnset(generateNoise, DEFAULT_GENERATE_NOISE,
                                      generateNoise, 0, 1);
+  setDefaultOrBoxedFromSourceIfUnset(
+      levelStreamMillis, DEFAULT_LEVEL_STREAM_MILLIS, levelStreamMillis,
+      MIN_LEVEL_STREAM_MILLIS, MAX_LEVEL_STREAM_MILLIS);
   setDefaultOrBoxedFromSourceIfUnset(
       threshold_scaling, DEFAULT_THRESHOLD_SCALING, threshold_scaling,
       MIN_THRESHOLD_SCALING, MAX_THRESHOLD_SCALING);
@@ -22,6 +22,7 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <speakerman/SpeakermanWebServer.hpp>
 #include <speakerman/jack/SignalHandler.hpp>
 #include <speakerman/utils/Config.hpp>
@@ -31,51 +32,65 @@
 
 namespace speakerman {
 
-static void create_command_and_file(string &rangeFile, string &command_line) {
-  char number[33];
-  snprintf(number, 33, "%x", rand());
+void LimiterFaultBuffer::put(const LimiterFaultSnapshot &snapshot) {
+  LimiterFaultEntry entry;
+  entry.stamp = current_millis();
+  entry.limiter = snapshot.limiter;
+  std::ostringstream csv;
+  snapshot.writeCsv(csv);
+  entry.csv = csv.str();
+
+  unique_lock<mutex> lock(m);
+  entries[count_ % SIZE] = std::move(entry);
+  count_++;
+}
 
-  rangeFile = "/tmp/";
-  rangeFile += number;
-  snprintf(number, 33, "%llx", (long long int)getpid());
-  rangeFile += number;
-  rangeFile += ".ranges";
+size_t LimiterFaultBuffer::count() {
+  unique_lock<mutex> lock(m);
+  return count_;
+}
 
-  const char *script = getWatchDogScript();
-  if (script == nullptr) {
-    command_line = "";
-    return;
+bool LimiterFaultBuffer::get(size_t index, LimiterFaultEntry &target) {
+  unique_lock<mutex> lock(m);
+  if (index >= count_ || index >= SIZE) {
+    return false;
   }
-
-  command_line = script;
-  command_line += " ";
-  command_line += rangeFile;
-  command_line += " ";
-  command_line += configFileName();
+  target = entries[(count_ - 1 - index) % SIZE];
+  return true;
 }
 
-struct TemporaryFile {
-  ifstream file_;
-  string name_;
-
-  TemporaryFile(const char *name) : name_(name) { file_.open(name_); }
-
-  bool is_open() const { return file_.is_open(); }
-
-  const char *name() const { return name_.c_str(); }
-
-  istream &stream() { return file_; }
+void LevelPayloadBuffer::put(
+    const std::shared_ptr<const LevelPayload> &payload) {
+  unique_lock<mutex> lock(m);
+  entries[payload->sequence % SIZE] = payload;
+  latest_ = payload->sequence;
+}
 
-  ~TemporaryFile() {
-    if (file_.is_open()) {
-      file_.close();
+std::shared_ptr<const LevelPayload>
+LevelPayloadBuffer::mergeSince(uint64_t sequence,
+                               DynamicProcessorLevels &levels,
+                               long long &since) {
+  unique_lock<mutex> lock(m);
+  uint64_t first = sequence + 1;
+  if (latest_ >= SIZE) {
+    first = std::max(first, latest_ - SIZE + 1);
+  }
+  std::shared_ptr<const LevelPayload> latest;
+  for (uint64_t s = first; s <= latest_; s++) {
+    const std::shared_ptr<const LevelPayload> &entry = entries[s % SIZE];
+    if (!entry || entry->sequence != s) {
+      continue;
     }
-    int result = std::remove(name_.c_str());
-    if (result != 0) {
-      cerr << "Could not remove " << name_ << ": " << strerror(errno) << endl;
+    if (!latest) {
+      levels = DynamicProcessorLevels(entry->levels.groups());
+      levels.reset();
+      since = entry->previousStamp;
     }
+    levels += entry->levels;
+    latest = entry;
   }
-};
+  return latest;
+}
 
 static constexpr int SLEEP_MILLIS = 50;
 static constexpr int CONFIG_NUMBER_OF_SLEEPS = 10;
@@ -115,25 +130,20 @@ void web_server::thread_static_function(web_server *server) {
 void web_server::thread_function() {
   static std::chrono::milliseconds wait(WAIT_MILLIS);
   static std::chrono::milliseconds sleep(SLEEP_MILLIS);
-  int count = 1;
+  int count = 0;
 
   {
     tdap::MemoryFence fence;
     configFileConfig = manager_.getConfig();
   }
-  DynamicProcessorLevels levels;
-  string range_file;
-  string command_line;
-  int threshold_scaling_setting = 1;
-  double threshold_scaling = threshold_scaling_setting;
+  double threshold_scaling = ThresholdScalingMonitor::DEFAULT_SCALING;
   double new_threshold_scaling = threshold_scaling;
 
   while (!jack::SignalHandler::check_raised()) {
-    count++;
-    bool got_levels = false;
-    if ((count % CONFIG_NUMBER_OF_SLEEPS) == 0) {
+    if (++count == CONFIG_NUMBER_OF_SLEEPS) {
+      count = 0;
       approach_threshold_scaling(new_threshold_scaling,
-                                 threshold_scaling_setting);
+                                 thresholdScaling.scaling());
 
       bool read = false;
       auto stamp = getConfigFileTimeStamp();
@@ -155,120 +165,139 @@ void web_server::thread_function() {
         read = true;
       }
       if (read) {
-        got_levels = applyConfigAndGetLevels(levels, wait);
+        applyConfig(wait);
       }
     }
-    if (!got_levels && manager_.getLevels(&levels, wait)) {
-      level_buffer.put(levels);
+    drainLevels();
+    fetchLimiterFaults();
+    this_thread::sleep_for(sleep);
+  }
+}
+void web_server::fetchLimiterFaults() {
+  while (manager_.getLimiterFault(faultSnapshot)) {
+    cout << "Limiter fault captured on limiter " << faultSnapshot.limiter
+         << " at sample " << faultSnapshot.faultSample << endl;
+    fault_buffer.put(faultSnapshot);
+  }
+}
+
+void web_server::drainLevels() {
+  static constexpr size_t BATCH = 64;
+  PeriodLevels batch[BATCH];
+  DynamicProcessorLevels levels;
+  bool drained = false;
+  size_t count;
+  while ((count = manager_.getPeriodLevels(batch, BATCH)) > 0) {
+    if (!drained) {
+      levels = DynamicProcessorLevels(batch[0].count - 1);
+      levels.reset();
+      drained = true;
     }
-    if (count == 100) {
-      count = 0;
-      create_command_and_file(range_file, command_line);
-      int old_setting = threshold_scaling_setting;
-      threshold_scaling_setting = 1;
-      if (command_line.length() == 0) {
-        cerr << "Cannot find watchdog command" << endl;
-      } else if (system(command_line.c_str()) == 0) {
-        TemporaryFile file{range_file.c_str()};
-        if (file.is_open()) {
-          istream &stream = file.stream();
-          while (!stream.eof()) {
-            char chr = stream.get();
-            if (chr >= '1' && chr <= '5') {
-              threshold_scaling_setting = chr - '0';
-              break;
-            } else if (!utils::config::isWhiteSpace(chr)) {
-              break;
-            }
-          }
-        }
-      }
-      if (old_setting != threshold_scaling_setting) {
-        cout << "Threshold scaling set from " << old_setting << " to "
-             << threshold_scaling_setting << endl;
-      }
+    for (size_t i = 0; i < count; i++) {
+      levels += batch[i];
     }
-    this_thread::sleep_for(sleep);
   }
+  if (drained) {
+    publishLevels(levels);
+  }
+}
+
+void web_server::publishLevels(const DynamicProcessorLevels &levels) {
+  std::shared_ptr<const LevelPayload> previous = levelPayload.load();
+  long long stamp = current_millis();
+  long long previousStamp = previous ? previous->stamp : stamp;
+  uint64_t sequence = previous ? previous->sequence + 1 : 1;
+  const jack::ProcessingStatistics &statistics = manager_.getStatistics();
+  levelRecord.set(sequence, stamp, levels,
+                  manager_.getConfig().threshold_scaling,
+                  statistics.getLongTermCorePercentage(),
+                  statistics.getShortTermCorePercentage());
+  levelRecords.put(levelRecord);
+  levelHistory.add(stamp, levels);
+  writeLevelUpdate(levelFrame, sequence, stamp - previousStamp, levels);
+  char etag[32];
+  snprintf(etag, sizeof(etag), "\"levels-%llu\"",
+           (unsigned long long)sequence);
+  auto payload = std::make_shared<const LevelPayload>(LevelPayload{
+      sequence, stamp, previousStamp, levels, levelFrame.getBody(), etag});
+  levelPayloads.put(payload);
+  levelPayload.store(payload);
 }
-bool web_server::applyConfigAndGetLevels(DynamicProcessorLevels &levels,
-                                         milliseconds &wait) {
-  if (manager_.applyConfigAndGetLevels(configFileConfig, &levels, wait)) {
-    level_buffer.put(levels);
-    return true;
+
+void web_server::writeLevelUpdate(Response &target, uint64_t sequence,
+                                  long long elapsedMillis,
+                                  const DynamicProcessorLevels &levels) {
+  target.clear();
+  Json json(target);
+  json.setNumber("sequence", sequence);
+  json.setNumber("elapsedMillis", elapsedMillis);
+  writeLevels(json, levels);
+}
+
+/**
+ * Returns the latest update that a client that saw the update with the given
+ * sequence should get and points json to the levels to send. If the client
+ * missed updates, those are the merged levels of all updates it did not see,
+ * written to target. Otherwise, it is the payload as published. A sequence of
+ * zero or one after the latest update, as after a restart, gets the latest
+ * update.
+ */
+std::shared_ptr<const LevelPayload>
+web_server::levelsSince(uint64_t sequence, Response &target,
+                        const std::string *&json) {
+  std::shared_ptr<const LevelPayload> latest = levelPayload.load();
+  if (!latest) {
+    return nullptr;
+  }
+  json = &latest->json;
+  if (sequence == 0 || sequence + 1 >= latest->sequence) {
+    return latest;
+  }
+  long long since;
+  std::shared_ptr<const LevelPayload> merged =
+      levelPayloads.mergeSince(sequence, mergedLevels, since);
+  if (!merged) {
+    return latest;
+  }
+  writeLevelUpdate(target, merged->sequence, merged->stamp - since,
+                   mergedLevels);
+  json = &target.getBody();
+  return merged;
+}
+
+uint64_t web_server::levelSequence(const mg_str *etag) {
+  static constexpr const char *PREFIX = "\"levels-";
+  size_t length = strlen(PREFIX);
+  if (etag == nullptr || etag->len <= length ||
+      strncmp(etag->ptr, PREFIX, length) != 0) {
+    return 0;
   }
-  return false;
+  return strtoull(etag->ptr + length, nullptr, 10);
+}
+
+bool web_server::applyConfig(milliseconds &wait) {
+  return manager_.applyConfig(configFileConfig, wait);
 }
 
 web_server::web_server(SpeakerManagerControl &speakerManager)
-    : WebServer(getWebSiteDirectory()), manager_(speakerManager) {
+    : WebServer(getWebSiteDirectory()), manager_(speakerManager),
+      levelHistory(levelHistoryFileName()),
+      thresholdScaling(
+          configFileName(),
+          static_cast<int>(SpeakermanConfig::MAX_THRESHOLD_SCALING)) {
   thread t(thread_static_function, this);
   level_fetch_thread.swap(t);
   level_fetch_thread.detach();
 }
 
-// TODO rename to handleCookieTimestamp
-void web_server::handleTimeStampCookie(const char *header, const char *value) {
-  static constexpr int ASSIGN = 1;
-  static constexpr int VALUE = 2;
-  static constexpr int NUM = 3;
-  static constexpr int DONE = 4;
-  unsigned long long number = 0;
-  unsigned long long previousNumber = 0;
-  if (strcasecmp("cookie", header) == 0) {
-    const char *pos = strstr(value, COOKIE_TIME_STAMP);
-    if (pos) {
-      pos += COOKIE_TIME_STAMP_LENGTH;
-      int status = ASSIGN;
-      char c;
-      while (status != DONE && (c = *pos++) != 0) {
-        switch (status) {
-        case ASSIGN:
-          if (c == '=') {
-            status = VALUE;
-          } else if (c != ' ') {
-            return;
-          }
-          break;
-        case VALUE:
-          if (c == ' ') {
-            continue;
-          }
-          if (c == ';') {
-            return;
-          }
-          if (c >= '0' && c <= '9') {
-            number = c - '0';
-            status = NUM;
-          } else {
-            return;
-          }
-          break;
-        case NUM:
-          if (c >= '0' && c <= '9') {
-            previousNumber = number;
-            number *= 10;
-            number += c - '0';
-            if (number < previousNumber) {
-              status = DONE;
-            }
-          } else if (c == ';') {
-            status = DONE;
-          }
-          break;
-        }
-      }
-      levelTimeStamp = number;
-    }
-  }
-}
-
 static bool matches(const mg_str &string1, const char *string2) {
-  return strncmp(string2, string1.ptr, string1.len) == 0;
+  return strlen(string2) == string1.len &&
+         strncmp(string2, string1.ptr, string1.len) == 0;
 }
 
 static bool matchesCI(const mg_str &string1, const char *string2) {
-  return strncasecmp(string2, string1.ptr, string1.len) == 0;
+  return strlen(string2) == string1.len &&
+         strncasecmp(string2, string1.ptr, string1.len) == 0;
 }
 
 static bool operator==(const mg_str &string1, const char *string2) {
@@ -278,52 +307,107 @@ static bool operator==(const mg_str &string1, const char *string2) {
 
 HttpResultHandleResult web_server::handle(mg_connection *connection,
                                           mg_http_message *httpMessage) {
-  std::unique_lock<std::mutex> guard(handlingMutex);
   response.clear();
 
-  static constexpr size_t LENGTH = 10240;
-  std::unique_ptr<char> str(new char[LENGTH + 1]);
-
   mg_str &method = httpMessage->method;
   mg_str &uri = httpMessage->uri;
   if (matchesCI(method, "GET")) {
-    if (uri == "/levels") {
-      LevelEntry entry;
-      level_buffer.get(levelTimeStamp, entry);
-      if (entry.set) {
-        mg_str *cookie = mg_http_get_header(httpMessage, "cookie");
-        if (cookie) {
-          handleTimeStampCookie("cookie", cookie->ptr);
-        }
-        DynamicProcessorLevels levels = entry.levels;
-        response.addCookie(COOKIE_TIME_STAMP, entry.stamp, "SameSite=Strict");
-        response.addHeader("Access-Control-Allow-Origin", "*");
-        response.setContentType("application/json", true);
-        {
-          Json json(response);
-          json.setNumber("elapsedMillis", entry.stamp - levelTimeStamp);
-          json.setNumber("thresholdScale", manager_.getConfig().threshold_scaling);
-          json.setNumber("subLevel", levels.getSignal(0));
-          json.setNumber("periods", levels.count());
-          const jack::ProcessingStatistics &statistics = manager_.getStatistics();
-          json.setNumber("cpuLongTerm", statistics.getLongTermCorePercentage());
-          json.setNumber("cpuShortTerm", statistics.getShortTermCorePercentage());
-          {
-            auto groups = json.addArray("group");
-            for (size_t i = 0; i < levels.groups(); i++) {
-              Json group = groups.addArrayObject();
-              group.setString("group_name", manager_.getConfig().processingGroups.group[i].name);
-              group.setNumber("level", levels.getSignal(i + 1));
-            }
-          }
-          writeInputVolumes(json);
-        }
-        response.createReply(connection, 200);
+    if (uri == "/levels/stream") {
+      mg_ws_upgrade(connection, httpMessage, nullptr);
+      snprintf(connection->label, sizeof(connection->label), "%s",
+               LEVEL_STREAM_LABEL);
+      return HttpResultHandleResult::Ok;
+    } else if (uri == "/levels") {
+      mg_str *ifNoneMatch = mg_http_get_header(httpMessage, "If-None-Match");
+      uint64_t after = levelSequence(ifNoneMatch);
+      char number[21];
+      if (mg_http_get_var(&httpMessage->query, "after", number,
+                          sizeof(number)) > 0) {
+        after = strtoull(number, nullptr, 10);
+      }
+      const std::string *json;
+      std::shared_ptr<const LevelPayload> payload =
+          levelsSince(after, response, json);
+      if (!payload) {
+        mg_http_reply(connection, 503, NULL, "Temporarily unavailable");
+        return HttpResultHandleResult::Ok;
+      }
+      response.addHeader("Access-Control-Allow-Origin", "*");
+      response.addHeader("Cache-Control", "no-cache");
+      response.addHeader("ETag", payload->etag.c_str());
+      if (ifNoneMatch && *ifNoneMatch == payload->etag.c_str()) {
+        response.createReply(connection, 304, std::string());
         return HttpResultHandleResult::Ok;
+      }
+      response.setContentType("application/json", true);
+      response.createReply(connection, 200, *json);
+      return HttpResultHandleResult::Ok;
+    } else if (uri == "/levels.bin") {
+      char number[21];
+      if (mg_http_get_var(&httpMessage->query, "after", number,
+                          sizeof(number)) > 0) {
+        levelRecords.writeSince(strtoull(number, nullptr, 10),
+                                levelRecordReply);
       } else {
-        mg_http_reply(connection, 503, NULL, "Temporarily unavailable");
+        levelRecords.writeLatest(levelRecordReply);
+      }
+      response.addHeader("Access-Control-Allow-Origin", "*");
+      response.addHeader("Cache-Control", "no-cache");
+      response.setContentType("application/octet-stream", false);
+      response.createReply(connection, 200, levelRecordReply);
+      return HttpResultHandleResult::Ok;
+    } else if (uri == "/levels/history") {
+      bool valid;
+      {
+        Json json(response);
+        valid = writeLevelHistory(json, httpMessage);
+      }
+      if (!valid) {
+        mg_http_reply(connection, 400, NULL,
+                      "Invalid time range or resolution");
+        return HttpResultHandleResult::Ok;
+      }
+      response.addHeader("Access-Control-Allow-Origin", "*");
+      response.setContentType("application/json", true);
+      response.createReply(connection, 200);
+      return HttpResultHandleResult::Ok;
+    } else if (uri == "/limiter-faults") {
+      size_t count = fault_buffer.count();
+      response.addHeader("Access-Control-Allow-Origin", "*");
+      response.setContentType("application/json", true);
+      {
+        Json json(response);
+        json.setNumber("count", count);
+        auto faults = json.addArray("faults");
+        LimiterFaultEntry entry;
+        for (size_t i = 0; fault_buffer.get(i, entry); i++) {
+          Json fault = faults.addArrayObject();
+          fault.setNumber("index", i);
+          fault.setNumber("stamp", entry.stamp);
+          fault.setNumber("limiter", entry.limiter);
+        }
+      }
+      response.createReply(connection, 200);
+      return HttpResultHandleResult::Ok;
+    } else if (uri == "/limiter-fault.csv") {
+      char number[21];
+      size_t index = 0;
+      if (mg_http_get_var(&httpMessage->query, "index", number,
+                          sizeof(number)) > 0) {
+        index = strtoul(number, nullptr, 10);
+      }
+      LimiterFaultEntry entry;
+      if (!fault_buffer.get(index, entry)) {
+        mg_http_reply(connection, 404, NULL, "No such limiter fault");
         return HttpResultHandleResult::Ok;
       }
+      response.addHeader("Access-Control-Allow-Origin", "*");
+      response.addHeader("Content-Disposition", "attachment",
+                         "filename=\"limiter-fault.csv\"");
+      response.setContentType("text/csv", true);
+      response.write_string(entry.csv.c_str());
+      response.createReply(connection, 200);
+      return HttpResultHandleResult::Ok;
     } else if (uri == "/config") {
       response.addHeader("Access-Control-Allow-Origin", "*");
       response.setContentType("application/json", true);
@@ -344,6 +428,125 @@ HttpResultHandleResult web_server::handle(mg_connection *connection,
   return HttpResultHandleResult::Default;
 }
 
+void web_server::writeLevels(Json &json,
+                             const DynamicProcessorLevels &levels) {
+  json.setNumber("thresholdScale", manager_.getConfig().threshold_scaling);
+  json.setNumber("subLevel", levels.getSignal(0));
+  json.setNumber("subPeak", levels.getPeak(0));
+  json.setNumber("subGain", levels.getGain(0));
+  json.setNumber("periods", levels.count());
+  const jack::ProcessingStatistics &statistics = manager_.getStatistics();
+  json.setNumber("cpuLongTerm", statistics.getLongTermCorePercentage());
+  json.setNumber("cpuShortTerm", statistics.getShortTermCorePercentage());
+  {
+    auto groups = json.addArray("group");
+    for (size_t i = 0; i < levels.groups(); i++) {
+      Json group = groups.addArrayObject();
+      group.setString("group_name",
+                      manager_.getConfig().processingGroups.group[i].name);
+      group.setNumber("level", levels.getSignal(i + 1));
+      group.setNumber("peak", levels.getPeak(i + 1));
+      group.setNumber("gain", levels.getGain(i + 1));
+    }
+  }
+  writeInputVolumes(json);
+}
+
+bool web_server::writeLevelHistory(Json &json,
+                                   mg_http_message *httpMessage) {
+  char value[21];
+  long long now = current_millis() / 1000;
+  long long to = now;
+  if (mg_http_get_var(&httpMessage->query, "to", value, sizeof(value)) > 0) {
+    to = strtoll(value, nullptr, 10);
+  }
+  long long from = to - LevelHistory::SECOND_BUCKETS + 1;
+  if (mg_http_get_var(&httpMessage->query, "from", value, sizeof(value)) >
+      0) {
+    from = strtoll(value, nullptr, 10);
+  }
+  if (from > to) {
+    return false;
+  }
+  LevelHistory::Resolution resolution =
+      from > now - (long long)LevelHistory::SECOND_BUCKETS
+          ? LevelHistory::Resolution::Seconds
+          : LevelHistory::Resolution::Minutes;
+  if (mg_http_get_var(&httpMessage->query, "resolution", value,
+                      sizeof(value)) > 0) {
+    if (strcmp(value, "seconds") == 0) {
+      resolution = LevelHistory::Resolution::Seconds;
+    } else if (strcmp(value, "minutes") == 0) {
+      resolution = LevelHistory::Resolution::Minutes;
+    } else {
+      return false;
+    }
+  }
+  levelHistory.query(from, to, resolution, historyBuckets);
+  auto writeStatistic = [](Json &parent, const char *name,
+                           const LevelStatistic &statistic,
+                           uint32_t samples) {
+    Json object = parent.addObject(name);
+    object.setNumber("min", statistic.minimum);
+    object.setNumber("max", statistic.maximum);
+    object.setNumber("mean", statistic.sum / samples);
+  };
+
+  json.setNumber("from", from);
+  json.setNumber("to", to);
+  json.setNumber("bucketSeconds", LevelHistory::seconds(resolution));
+  json.setBoolean("persistent", levelHistory.persistent());
+  auto buckets = json.addArray("buckets");
+  for (const LevelHistoryBucket &bucket : historyBuckets) {
+    Json entry = buckets.addArrayObject();
+    entry.setNumber("start", bucket.start);
+    entry.setNumber("samples", bucket.samples);
+    auto levels = entry.addArray("levels");
+    for (size_t i = 0; i < bucket.levels; i++) {
+      Json level = levels.addArrayObject();
+      writeStatistic(level, "level", bucket.level[i], bucket.samples);
+      writeStatistic(level, "peak", bucket.peak[i], bucket.samples);
+      writeStatistic(level, "gain", bucket.gain[i], bucket.samples);
+    }
+  }
+  return true;
+}
+
+bool web_server::isLevelSubscriber(const mg_connection *connection) {
+  return connection->is_websocket && !connection->is_closing &&
+         !connection->is_draining &&
+         strncmp(connection->label, LEVEL_STREAM_LABEL,
+                 sizeof(connection->label)) == 0;
+}
+
+void web_server::onPoll(mg_mgr *manager) {
+  long long now = current_millis();
+  if (now < nextStreamMillis) {
+    return;
+  }
+  nextStreamMillis = now + manager_.getConfig().levelStreamMillis;
+  bool subscribed = false;
+  for (mg_connection *c = manager->conns; c != nullptr && !subscribed;
+       c = c->next) {
+    subscribed = isLevelSubscriber(c);
+  }
+  if (!subscribed) {
+    return;
+  }
+  const std::string *frame;
+  std::shared_ptr<const LevelPayload> payload =
+      levelsSince(streamSequence, streamFrame, frame);
+  if (!payload || payload->sequence == streamSequence) {
+    return;
+  }
+  streamSequence = payload->sequence;
+  for (mg_connection *c = manager->conns; c != nullptr; c = c->next) {
+    if (isLevelSubscriber(c) && c->send.len < LEVEL_STREAM_BACKLOG) {
+      mg_ws_send(c, frame->c_str(), frame->length(), WEBSOCKET_OP_TEXT);
+    }
+  }
+}
+
 void web_server::writeInputVolumes(Json &json) {
   const LogicalInputsConfig &liConfig = manager_.getConfig().logicalInputs;
   size_t groupCount = liConfig.getGroupCount();
@@ -358,9 +561,8 @@ void web_server::writeInputVolumes(Json &json) {
 void web_server::handleConfigurationChanges(mg_connection *connection,
                                             const char *configurationJson) {
   static std::chrono::milliseconds wait(WAIT_MILLIS);
-  DynamicProcessorLevels levels;
   if (readConfigFromJson(configFileConfig, configurationJson, configFileConfig)) {
-    applyConfigAndGetLevels(levels, wait);
+    applyConfig(wait);
     {
       Json json(response);
       writeInputVolumes(json);
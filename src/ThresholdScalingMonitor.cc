@@ -0,0 +1,283 @@
+/*
+ * speakerman/ThresholdScalingMonitor.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
+#include <spawn.h>
+#include <speakerman/ThresholdScalingMonitor.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace speakerman {
+
+namespace {
+
+constexpr int STOP_CHECK_MILLIS = 100;
+
+const char *skipSpaces(const char *p) {
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * Appends count digits to value, as if they were written after it.
+ */
+bool readDigits(const char *&p, int count, long long &value) {
+  for (int i = 0; i < count; i++, p++) {
+    if (!isdigit(static_cast<unsigned char>(*p))) {
+      return false;
+    }
+    value = 10 * value + (*p - '0');
+  }
+  return true;
+}
+
+/**
+ * Reads a stamp like 202610182000 or 2026-10-18 20:00, where the date and time
+ * can also be separated by 'T' or '_'.
+ */
+bool readStamp(const char *&p, long long &stamp) {
+  stamp = 0;
+  const char *start = p;
+  if (readDigits(p, 12, stamp) && !isdigit(static_cast<unsigned char>(*p))) {
+    return true;
+  }
+  p = start;
+  stamp = 0;
+  return readDigits(p, 4, stamp) && *p++ == '-' && readDigits(p, 2, stamp) &&
+         *p++ == '-' && readDigits(p, 2, stamp) &&
+         (*p == 'T' || *p == '_' || *p == ' ') && readDigits(++p, 2, stamp) &&
+         *p++ == ':' && readDigits(p, 2, stamp);
+}
+
+/**
+ * Returns the scaling of a line "start - end : scaling [text]" if now is
+ * within the range, zero otherwise.
+ */
+int activeScaling(const char *line, long long now, int maximum) {
+  const char *p = skipSpaces(line);
+  long long start;
+  long long end;
+  if (!readStamp(p, start)) {
+    return 0;
+  }
+  p = skipSpaces(p);
+  if (*p++ != '-') {
+    return 0;
+  }
+  p = skipSpaces(p);
+  if (!readStamp(p, end)) {
+    return 0;
+  }
+  p = skipSpaces(p);
+  if (*p++ != ':') {
+    return 0;
+  }
+  p = skipSpaces(p);
+  if (*p < '1' || *p > '0' + maximum) {
+    return 0;
+  }
+  int scaling = *p++ - '0';
+  if (*p != 0 && !isspace(static_cast<unsigned char>(*p))) {
+    return 0;
+  }
+  return now >= start && now <= end ? scaling : 0;
+}
+
+} // namespace
+
+ThresholdScalingMonitor::ThresholdScalingMonitor(const char *configFile,
+                                                 int maximum)
+    : configFile_(configFile), maximum_(maximum) {
+  thread_ = std::thread([this]() { run(); });
+}
+
+ThresholdScalingMonitor::~ThresholdScalingMonitor() {
+  stop_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+int ThresholdScalingMonitor::scalingForRanges(const char *text, long long now,
+                                              int maximum) {
+  std::string line;
+  const char *p = text;
+  while (*p) {
+    const char *end = p;
+    while (*end != 0 && *end != '\n') {
+      end++;
+    }
+    const char *comment = static_cast<const char *>(memchr(p, '#', end - p));
+    line.assign(p, comment ? comment : end);
+    int scaling = activeScaling(line.c_str(), now, maximum);
+    if (scaling > 0) {
+      return scaling;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return DEFAULT_SCALING;
+}
+
+long long ThresholdScalingMonitor::localStamp() {
+  time_t now = time(nullptr);
+  struct tm local;
+  localtime_r(&now, &local);
+  return (local.tm_year + 1900LL) * 100000000LL +
+         (local.tm_mon + 1) * 1000000LL + local.tm_mday * 10000LL +
+         local.tm_hour * 100LL + local.tm_min;
+}
+
+void ThresholdScalingMonitor::run() {
+  std::string text;
+  text.reserve(MAX_DOWNLOAD_BYTES);
+  while (!stop_) {
+    int scaling = DEFAULT_SCALING;
+    if (download(readUrl(), text)) {
+      scaling = scalingForRanges(text.c_str(), localStamp(), maximum_);
+    }
+    int old = scaling_.exchange(scaling);
+    if (old != scaling) {
+      std::cout << "Threshold scaling set from " << old << " to " << scaling
+                << std::endl;
+    }
+    sleep(CHECK_SECONDS);
+  }
+}
+
+void ThresholdScalingMonitor::sleep(int seconds) const {
+  for (int i = 0; !stop_ && i < seconds * 1000 / STOP_CHECK_MILLIS; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(STOP_CHECK_MILLIS));
+  }
+}
+
+std::string ThresholdScalingMonitor::readUrl() const {
+  static constexpr const char *KEY = "threshold-scale-url";
+  std::ifstream file(configFile_);
+  std::string line;
+  while (file.is_open() && std::getline(file, line)) {
+    const char *p = skipSpaces(line.c_str());
+    if (strncmp(p, KEY, strlen(KEY)) != 0) {
+      continue;
+    }
+    p = skipSpaces(p + strlen(KEY));
+    if (*p++ != '=') {
+      continue;
+    }
+    p = skipSpaces(p);
+    const char *scheme = p;
+    while (*p >= 'a' && *p <= 'z') {
+      p++;
+    }
+    if (p == scheme || strncmp(p, "://", 3) != 0) {
+      continue;
+    }
+    std::string url = scheme;
+    while (!url.empty() && isspace(static_cast<unsigned char>(url.back()))) {
+      url.pop_back();
+    }
+    return url;
+  }
+  return DEFAULT_URL;
+}
+
+bool ThresholdScalingMonitor::download(const std::string &url,
+                                       std::string &output) const {
+  output.clear();
+  int pipeFds[2];
+  if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+    std::cerr << "Threshold scaling: cannot create pipe: " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  std::string maxTime = std::to_string(DOWNLOAD_SECONDS);
+  const char *arguments[] = {"curl",          "-sL", "--max-time",
+                             maxTime.c_str(), "--",  url.c_str(),
+                             nullptr};
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t signals;
+  sigemptyset(&signals);
+  posix_spawnattr_setsigmask(&attributes, &signals);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK);
+
+  pid_t pid;
+  int spawned = posix_spawnp(&pid, arguments[0], &actions, &attributes,
+                             const_cast<char *const *>(arguments), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attributes);
+  close(pipeFds[1]);
+  if (spawned != 0) {
+    std::cerr << "Threshold scaling: cannot start curl: " << strerror(spawned)
+              << std::endl;
+    close(pipeFds[0]);
+    return false;
+  }
+
+  char buffer[4096];
+  pollfd readable{pipeFds[0], POLLIN, 0};
+  while (!stop_) {
+    int ready = poll(&readable, 1, STOP_CHECK_MILLIS);
+    if (ready < 0 && errno != EINTR) {
+      break;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+    ssize_t count = read(pipeFds[0], buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      break;
+    }
+    size_t size = std::min(static_cast<size_t>(count),
+                           MAX_DOWNLOAD_BYTES - output.length());
+    output.append(buffer, size);
+  }
+  close(pipeFds[0]);
+  if (stop_) {
+    kill(pid, SIGTERM);
+  }
+  int status = -1;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  return !stop_ && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace speakerman
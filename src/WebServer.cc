@@ -44,18 +44,68 @@ void WebServer::staticHandle(struct mg_connection *connection, int event,
 }
 
 WebServer::WebServer(const char *staticDocumentRoot)
-    : documentRoot(staticDocumentRoot) {}
+    : documentRoot(staticDocumentRoot),
+      indexHtml(staticDocumentRoot ? staticDocumentRoot : ".", "index.html"),
+      script(staticDocumentRoot ? staticDocumentRoot : ".", "speakerman.js"),
+      styleSheet(staticDocumentRoot ? staticDocumentRoot : ".",
+                 "speakerman.css") {}
+
+file_entry *WebServer::cachedAsset(const mg_str &uri) {
+  if (mg_vcmp(&uri, "/") == 0 || mg_vcmp(&uri, "/index.html") == 0) {
+    return &indexHtml;
+  }
+  if (mg_vcmp(&uri, "/speakerman.js") == 0) {
+    return &script;
+  }
+  if (mg_vcmp(&uri, "/speakerman.css") == 0) {
+    return &styleSheet;
+  }
+  return nullptr;
+}
+
+bool WebServer::serveCached(mg_connection *connection,
+                            mg_http_message *httpMessage) {
+  if (mg_vcasecmp(&httpMessage->method, "GET") != 0) {
+    return false;
+  }
+  file_entry *asset = cachedAsset(httpMessage->uri);
+  if (asset == nullptr) {
+    return false;
+  }
+  asset->reset();
+  if (asset->size() == 0) {
+    return false;
+  }
+  const char *etag = asset->etag().c_str();
+  mg_str *ifNoneMatch = mg_http_get_header(httpMessage, "If-None-Match");
+  if (ifNoneMatch && mg_strstr(*ifNoneMatch, mg_str(etag))) {
+    mg_printf(connection,
+              "HTTP/1.1 304 Not Modified\r\nETag: %s\r\n"
+              "Cache-Control: no-cache\r\nContent-Length: 0\r\n\r\n",
+              etag);
+    return true;
+  }
+  mg_str *acceptEncoding = mg_http_get_header(httpMessage, "Accept-Encoding");
+  bool gzip = !asset->gzipped().empty() && acceptEncoding &&
+              mg_strstr(*acceptEncoding, mg_str("gzip"));
+  const char *body = gzip ? asset->gzipped().data() : asset->data();
+  size_t length = gzip ? asset->gzipped().length() : asset->size();
+  mg_printf(connection,
+            "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nETag: %s\r\n"
+            "Cache-Control: no-cache\r\nVary: Accept-Encoding\r\n"
+            "%sContent-Length: %zu\r\n\r\n",
+            asset->contentType(), etag,
+            gzip ? "Content-Encoding: gzip\r\n" : "", length);
+  mg_send(connection, body, length);
+  return true;
+}
 
 void WebServer::defaultHandle(mg_connection *connection,
                               mg_http_message *httpMessage) {
 
   try {
-    if (std::strncmp(httpMessage->uri.ptr, "/ ", 2) == 0) {
-      std::string path = documentRoot;
-      path += "/index.html";
-      mg_http_serve_opts opts = { .root_dir = documentRoot, .ssi_pattern = "#.shtml", .mime_types="text/html" };
-      mg_http_serve_file(connection, httpMessage, path.c_str(), &opts);
-      return ;
+    if (serveCached(connection, httpMessage)) {
+      return;
     }
     switch (handle(connection, httpMessage)) {
     case HttpResultHandleResult::Ok:
@@ -111,6 +161,7 @@ void WebServer::run(const char *listeningAddress, long pollMillis) {
       break;
     }
     mg_mgr_poll(manager(), pollMillis);
+    onPoll(manager());
   }
 }
 
@@ -43,12 +43,14 @@ struct DetectionConfig {
   static constexpr double MAX_RMS_FAST_RELEASE_SECONDS = 0.10;
 
   static constexpr int DEFAULT_USE_BRICK_WALL_PREDICTION = 1;
+  static constexpr int DEFAULT_USE_TRUE_PEAK = 0;
 
   double maximum_window_seconds = DEFAULT_MAXIMUM_WINDOW_SECONDS;
   double minimum_window_seconds = DEFAULT_MINIMUM_WINDOW_SECONDS;
   double rms_fast_release_seconds = DEFAULT_RMS_FAST_RELEASE_SECONDS;
   size_t perceptive_levels = DEFAULT_PERCEPTIVE_LEVELS;
   int useBrickWallPrediction = DEFAULT_USE_BRICK_WALL_PREDICTION;
+  int useTruePeak = DEFAULT_USE_TRUE_PEAK;
 
   static const DetectionConfig defaultConfig() { return {}; }
 
@@ -26,13 +26,55 @@
 #include <tdap/Value.hpp>
 
 #include <cstddef>
+#include <cstdint>
 namespace speakerman {
 
 using tdap::IndexPolicy;
 using tdap::Values;
 
+/**
+ * Compact levels of a single processing period, for the sub (index zero)
+ * and each group, that the processing thread hands over after each period.
+ */
+struct PeriodLevels {
+  static constexpr size_t MAX_LEVELS = ProcessingGroupsConfig::MAX_GROUPS + 1;
+
+  uint64_t period;
+  uint32_t frames;
+  uint32_t count;
+  // Maximum RMS detection
+  float rms[MAX_LEVELS];
+  // Maximum peak before the limiter
+  float peak[MAX_LEVELS];
+  // Minimum limiter gain
+  float gain[MAX_LEVELS];
+
+  void start(uint64_t newPeriod, size_t levels) noexcept {
+    period = newPeriod;
+    frames = 0;
+    count = levels;
+    for (size_t i = 0; i < MAX_LEVELS; i++) {
+      rms[i] = 0;
+      peak[i] = 0;
+      gain[i] = 1;
+    }
+  }
+
+  void addRms(size_t level, double value) noexcept {
+    rms[level] = Values::max(rms[level], float(value));
+  }
+
+  void addPeakAndGain(size_t level, double peakValue,
+                      double gainValue) noexcept {
+    peak[level] = Values::max(peak[level], float(peakValue));
+    gain[level] = Values::min(gain[level], float(gainValue));
+  }
+};
+
 class DynamicProcessorLevels {
   double signal_square_[ProcessingGroupsConfig::MAX_GROUPS + 1];
+  double peak_[ProcessingGroupsConfig::MAX_GROUPS + 1];
+  double gain_[ProcessingGroupsConfig::MAX_GROUPS + 1];
   size_t channels_;
   size_t count_;
 
@@ -56,15 +98,30 @@ public:
     for (size_t i = 0; i < count; i++) {
       signal_square_[i] =
           Values::max(signal_square_[i], levels.signal_square_[i]);
+      peak_[i] = Values::max(peak_[i], levels.peak_[i]);
+      gain_[i] = Values::min(gain_[i], levels.gain_[i]);
     }
     count_ += levels.count_;
   }
 
+  void operator+=(const PeriodLevels &levels) {
+    size_t count = Values::min(channels_, size_t(levels.count));
+    for (size_t i = 0; i < count; i++) {
+      signal_square_[i] =
+          Values::max(signal_square_[i], double(levels.rms[i]));
+      peak_[i] = Values::max(peak_[i], double(levels.peak[i]));
+      gain_[i] = Values::min(gain_[i], double(levels.gain[i]));
+    }
+    count_ += levels.frames;
+  }
+
   void next() { count_++; }
 
   void reset() {
     for (size_t limiter = 0; limiter < channels_; limiter++) {
       signal_square_[limiter] = 0.0;
+      peak_[limiter] = 0.0;
+      gain_[limiter] = 1.0;
     }
     count_ = 0;
   }
@@ -76,6 +133,14 @@ public:
   double getSignal(size_t group) const {
     return sqrt(signal_square_[IndexPolicy::array(group, channels_)]);
   }
+
+  double getPeak(size_t group) const {
+    return peak_[IndexPolicy::array(group, channels_)];
+  }
+
+  double getGain(size_t group) const {
+    return gain_[IndexPolicy::array(group, channels_)];
+  }
 };
 
 
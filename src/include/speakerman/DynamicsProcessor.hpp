@@ -22,8 +22,16 @@
  */
 
 #include <cmath>
+#include <future>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 #include <speakerman/DynamicProcessorLevels.h>
+#include <speakerman/LimiterFaultCapture.h>
 #include <speakerman/SpeakermanRuntimeData.hpp>
+#include <tdap/Allocation.hpp>
 #include <tdap/Crossovers.hpp>
 #include <tdap/Delay.hpp>
 #include <tdap/Followers.hpp>
@@ -32,6 +40,7 @@
 #include <tdap/Noise.hpp>
 #include <tdap/PerceptiveRms.hpp>
 #include <tdap/Transport.hpp>
+#include <tdap/TruePeak.hpp>
 #include <tdap/Weighting.hpp>
 
 namespace speakerman {
@@ -66,16 +75,12 @@ public:
       DetectionConfig::MAX_PERCEPTIVE_LEVELS;
 
   static constexpr double GROUP_MAX_DELAY = ProcessingGroupConfig::MAX_DELAY;
-  static constexpr double LIMITER_MAX_DELAY = 0.01;
   static constexpr double RMS_MAX_DELAY = 0.01;
   static constexpr double LIMITER_PREDICTION_SECONDS = 0.001;
   static constexpr double peakThreshold = 1.0;
 
-  static constexpr size_t GROUP_MAX_DELAY_SAMPLES =
-      0.5 + 192000 * ProcessingGroupConfig::MAX_DELAY;
-  static constexpr size_t LIMITER_MAX_DELAY_SAMPLES =
-      0.5 + 192000 * LIMITER_MAX_DELAY;
-  static constexpr size_t RMS_MAX_DELAY_SAMPLES = 0.5 + 192000 * RMS_MAX_DELAY;
+  // Buffers used to be dimensioned for this rate, which is used as reference
+  static constexpr double REFERENCE_SAMPLE_RATE = 192000;
   static constexpr double CHANNEL_ADD_FACTOR = 1.0 / CHANNELS_PER_GROUP;
   static constexpr double CHANNEL_RMS_FACTOR = (CHANNEL_ADD_FACTOR);
 
@@ -87,60 +92,95 @@ public:
   using ConfigData =
       SpeakermanRuntimeData<T, GROUPS, BANDS, LOGICAL_INPUTS, INPUTS>;
 
-  class GroupDelay : public MultiChannelAndTimeDelay<T> {
+  /**
+   * Delay compensation for the sub and group channels after the equalizer.
+   * Each channel has a single delay line that is read at two taps: the group
+   * (or sub) delay, where the limiter detects peaks, and that delay plus the
+   * limiter latency, where the limiter gain is applied. The RMS delay is not
+   * part of this, as its gain is applied per band, before the bands are
+   * merged into these channels.
+   */
+  class DelayPlan {
+    MultiChannelAndTimeDelay<T> lines_;
+    size_t maxChannelDelay_;
+    size_t maxLimiterLatency_;
+    size_t channelDelay_[DELAY_CHANNELS];
+    size_t limiterLatency_ = 0;
+
   public:
-    GroupDelay()
-        : MultiChannelAndTimeDelay<T>(DELAY_CHANNELS, GROUP_MAX_DELAY_SAMPLES) {
+    DelayPlan(size_t maxChannelDelay, size_t maxLimiterLatency)
+        : lines_(DELAY_CHANNELS, maxChannelDelay + maxLimiterLatency),
+          maxChannelDelay_(maxChannelDelay),
+          maxLimiterLatency_(maxLimiterLatency) {
+      std::fill_n(channelDelay_, DELAY_CHANNELS, 0);
     }
-  };
 
-  class LimiterDelay : public MultiChannelDelay<T> {
-  public:
-    LimiterDelay()
-        : MultiChannelDelay<T>(DELAY_CHANNELS, LIMITER_MAX_DELAY_SAMPLES) {}
+    void setChannelDelay(size_t channel, size_t delay) {
+      if (delay > maxChannelDelay_) {
+        throw std::runtime_error("DelayPlan::setChannelDelay invalid delay");
+      }
+      channelDelay_[channel] = delay;
+    }
+
+    void setLimiterLatency(size_t latency) {
+      if (latency > maxLimiterLatency_) {
+        throw std::runtime_error(
+            "DelayPlan::setLimiterLatency invalid latency");
+      }
+      limiterLatency_ = latency;
+    }
+
+    inline void set(size_t channel, T value) noexcept {
+      lines_.set(channel, value);
+    }
+
+    [[nodiscard]] inline T detection(size_t channel) const noexcept {
+      return lines_.tap(channel, channelDelay_[channel]);
+    }
+
+    [[nodiscard]] inline T limiterInput(size_t channel) const noexcept {
+      return lines_.tap(channel, channelDelay_[channel] + limiterLatency_);
+    }
+
+    void next() noexcept { lines_.next(); }
+
+    void zero() noexcept { lines_.zero(); }
   };
 
   class RmsDelay : public MultiChannelDelay<T> {
   public:
-    RmsDelay()
-        : MultiChannelDelay<T>(PROCESSING_CHANNELS, RMS_MAX_DELAY_SAMPLES) {}
+    explicit RmsDelay(size_t maxDelay)
+        : MultiChannelDelay<T>(PROCESSING_CHANNELS, maxDelay) {}
   };
 
   enum class LimiterClass { SMOOTH_TRIANGULAR, CRUDE };
 
+  /**
+   * Limiters for the sub and each group, stored inline per limiter class. The
+   * class is selected on configuration and processing dispatches on it once
+   * per call, so that the per-sample gain calculation is on a concrete (final)
+   * type and can be inlined. Reconfiguration does not allocate.
+   */
   class Limiters {
-    using LimiterPtr = Limiter<T> *;
-    LimiterPtr limiters[LIMITERS];
-
-    void free() {
-      for (size_t i = 0; i < LIMITERS; i++) {
-        LimiterPtr p = limiters[i];
-        if (p) {
-          limiters[i] = nullptr;
-          delete p;
-        }
-      }
-    }
+    FastLookAheadLimiter<T> smooth_[LIMITERS];
+    ZeroPredictionHardAttackLimiter<T> crude_[LIMITERS];
+    LimiterClass limiterClass_ = LimiterClass::CRUDE;
+    bool configured_ = false;
 
   public:
-    Limiters() {
-      for (size_t i = 0; i < LIMITERS; i++) {
-        limiters[i] = nullptr;
-      }
-    }
-
     void setPredictionAndThreshold(size_t prediction, T threshold, T sampleRate,
                                    LimiterClass limiterClass) {
-      free();
+      limiterClass_ = limiterClass;
       for (size_t i = 0; i < LIMITERS; i++) {
-        limiters[i] =
-            limiterClass == LimiterClass::SMOOTH_TRIANGULAR
-                ? dynamic_cast<LimiterPtr>(new FastLookAheadLimiter<T>)
-                : dynamic_cast<LimiterPtr>(
-                      new ZeroPredictionHardAttackLimiter<T>);
-        limiters[i]->setPredictionAndThreshold(prediction, threshold,
+        if (limiterClass == LimiterClass::SMOOTH_TRIANGULAR) {
+          smooth_[i].setPredictionAndThreshold(prediction, threshold,
                                                sampleRate);
+        } else {
+          crude_[i].setPredictionAndThreshold(prediction, threshold,
+                                              sampleRate);
+        }
       }
+      configured_ = true;
       std::cout << "PEAK limiter: type=";
       if (limiterClass == LimiterClass::SMOOTH_TRIANGULAR) {
         std::cout << "Inaudible smooth";
@@ -154,51 +194,217 @@ public:
     }
 
     size_t getLatency() const {
-      LimiterPtr p = limiters[0];
-      if (!p) {
+      if (!configured_) {
         throw std::runtime_error("Limiters::getLatency(): not initialized!");
       }
-      return p->latency();
+      return limiterClass_ == LimiterClass::SMOOTH_TRIANGULAR
+                 ? smooth_[0].latency()
+                 : crude_[0].latency();
     }
 
-    T getGain(size_t channel, T sample) noexcept {
-      return limiters[channel]->getGain(sample);
-    }
+    LimiterClass limiterClass() const noexcept { return limiterClass_; }
 
-    ~Limiters() { free(); }
+    FastLookAheadLimiter<T> *smooth() noexcept { return smooth_; }
+
+    ZeroPredictionHardAttackLimiter<T> *crude() noexcept { return crude_; }
   };
 
 private:
-  PinkNoise::Default noise;
-  double noiseAvg = 0;
-  IntegrationCoefficients<double> noiseIntegrator;
-  AlignedArray<T, INPUTS, 32> inputWithVolumeAndNoise;
-  AlignedArray<T, PROCESSING_CHANNELS, 32> processInput;
-  AlignedArray<T, OUTPUTS, 32> output;
-  FixedSizeArray<T, BANDS> relativeBandWeights;
-
-  Crossovers::Filter<double, T, INPUTS, CROSSOVERS> crossoverFilter;
-  ACurves::Filter<T, PROCESSING_CHANNELS> aCurve;
-
   using Detector = PerceptiveRms<
-      T, (size_t)(0.5 + 192000 * DetectionConfig::MAX_MAXIMUM_WINDOW_SECONDS),
-      RMS_DETECTION_LEVELS>;
-  using DetectorGroup = PerceptiveRms<
-      T, (size_t)(0.5 + 192000 * DetectionConfig::MAX_MAXIMUM_WINDOW_SECONDS),
+      T,
+      (size_t)(0.5 + REFERENCE_SAMPLE_RATE *
+                         DetectionConfig::MAX_MAXIMUM_WINDOW_SECONDS),
       RMS_DETECTION_LEVELS>;
+  using DetectorGroup = Detector;
+
+  /**
+   * Sizes of the buffers that scale with the sample rate, derived from the
+   * configuration maxima.
+   */
+  struct BufferPlan {
+    size_t rmsWindowSamples;
+    size_t rmsDelaySamples;
+    size_t channelDelaySamples;
+    size_t limiterLatencySamples;
+
+    static BufferPlan forSampleRate(double sampleRate) {
+      if (!(sampleRate > 0)) {
+        throw std::invalid_argument(
+            "DynamicsProcessor::BufferPlan: sample rate must be positive");
+      }
+      return {
+          (size_t)(0.5 +
+                   sampleRate * DetectionConfig::MAX_MAXIMUM_WINDOW_SECONDS),
+          (size_t)(0.5 + sampleRate * RMS_MAX_DELAY),
+          (size_t)(0.5 + sampleRate * GROUP_MAX_DELAY),
+          (size_t)(0.5 + sampleRate * LIMITER_PREDICTION_SECONDS) +
+              TruePeakDetector<T, 1>::LATENCY};
+    }
 
-  Detector subDetector;
-  DetectorGroup *groupDetector;
-  Limiters limiter;
-  IntegrationCoefficients<T> limiterRelease;
+    /**
+     * Returns the number of bytes used by the sample buffers of the plan.
+     */
+    [[nodiscard]] size_t bytes() const {
+      size_t lineSize =
+          Power2::next(channelDelaySamples + limiterLatencySamples + 1);
+      return sizeof(T) * ((1 + DETECTORS) * rmsWindowSamples +
+                          PROCESSING_CHANNELS * (rmsDelaySamples + 1) +
+                          DELAY_CHANNELS * lineSize);
+    }
 
-  GroupDelay groupDelay;
-  GroupDelay predictionDelay;
-  RmsDelay rmsDelay;
-  EqualizerFilter<double, CHANNELS_PER_GROUP> filters_[GROUPS + 1];
+    bool operator==(const BufferPlan &other) const {
+      return rmsWindowSamples == other.rmsWindowSamples &&
+             rmsDelaySamples == other.rmsDelaySamples &&
+             channelDelaySamples == other.channelDelaySamples &&
+             limiterLatencySamples == other.limiterLatencySamples;
+    }
+  };
+
+  /**
+   * The sub detector followed by the group detectors, stored contiguously in
+   * the order processing visits them. Detectors are sized on construction and
+   * cannot be moved, so they are constructed in place.
+   */
+  class Detectors {
+    static constexpr size_t COUNT = 1 + DETECTORS;
+    alignas(64) unsigned char storage_[COUNT * sizeof(Detector)];
+
+    Detector *at(size_t i) noexcept {
+      return std::launder(
+          reinterpret_cast<Detector *>(storage_ + i * sizeof(Detector)));
+    }
+
+  public:
+    explicit Detectors(size_t maxWindowSamples) {
+      size_t i = 0;
+      try {
+        for (; i < COUNT; i++) {
+          new (storage_ + i * sizeof(Detector)) Detector(maxWindowSamples);
+        }
+      } catch (...) {
+        while (i > 0) {
+          at(--i)->~Detector();
+        }
+        throw;
+      }
+    }
+
+    Detectors(const Detectors &) = delete;
+
+    ~Detectors() {
+      for (size_t i = 0; i < COUNT; i++) {
+        at(i)->~Detector();
+      }
+    }
+
+    static constexpr size_t size() { return COUNT; }
+
+    Detector &operator[](size_t i) noexcept { return *at(i); }
 
-  Configurable runtime;
+    Detector &sub() noexcept { return *at(0); }
 
+    DetectorGroup &group(size_t detector) noexcept { return *at(1 + detector); }
+  };
+
+  /**
+   * Detectors and delays, dimensioned by a BufferPlan, and band weights. These
+   * are prepared for a sample rate and replaced as a whole when the sample
+   * rate changes. Members used per sample come first, in processing order.
+   */
+  struct RateBuffers {
+    Detectors detectors;
+    RmsDelay rmsDelay;
+    DelayPlan delays;
+    const BufferPlan plan;
+    FixedSizeArray<T, BANDS> bandWeights;
+    // What detectors and band weights were prepared for
+    T sampleRate = 0;
+    DetectionConfig detection;
+    FixedSizeArray<T, CROSSOVERS> crossovers;
+
+    explicit RateBuffers(const BufferPlan &bufferPlan)
+        : detectors(bufferPlan.rmsWindowSamples),
+          rmsDelay(bufferPlan.rmsDelaySamples),
+          delays(bufferPlan.channelDelaySamples,
+                 bufferPlan.limiterLatencySamples),
+          plan(bufferPlan) {}
+
+    bool preparedFor(T rate, const FixedSizeArray<T, CROSSOVERS> &frequencies,
+                     const DetectionConfig &config) const {
+      if (rate != sampleRate ||
+          config.maximum_window_seconds != detection.maximum_window_seconds ||
+          config.minimum_window_seconds != detection.minimum_window_seconds ||
+          config.perceptive_levels != detection.perceptive_levels) {
+        return false;
+      }
+      for (size_t i = 0; i < CROSSOVERS; i++) {
+        if (frequencies[i] != crossovers[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  /**
+   * Locked and pre-faulted memory for one set of RateBuffers, that is reused
+   * once the buffers in it are freed.
+   */
+  class BufferArea : public tdap::ConsecutiveAllocationOwner {
+  public:
+    explicit BufferArea(size_t bytes) : ConsecutiveAllocationOwner(bytes) {
+      if (!lock_memory()) {
+        std::cerr << "Could not lock sample buffer area of " << bytes
+                  << " bytes" << std::endl;
+      }
+    }
+
+    /**
+     * Returns whether the area is free and, if so, makes all of it available
+     * for allocation again.
+     */
+    bool reuse() { return reset_allocation(); }
+  };
+
+  /*
+   * State used per sample, in the order that the processing stages touch it.
+   * Each stage starts on its own cache line, so that a stage does not share
+   * lines with its neighbours.
+   */
+  // Approached per frame and read by all stages
+  alignas(64) Configurable runtime;
+  // Input matrix and noise
+  alignas(64) PinkNoise::Default noise;
+  AlignedArray<T, INPUTS, 32> inputWithVolumeAndNoise;
+  // Crossovers
+  alignas(64) Crossovers::Filter<double, T, INPUTS, CROSSOVERS> crossoverFilter;
+  // RMS detection and its delay
+  alignas(64) AlignedArray<T, PROCESSING_CHANNELS, 32> processInput;
+  ACurves::Filter<T, PROCESSING_CHANNELS> aCurve;
+  std::unique_ptr<RateBuffers> buffers_;
+  // Mixing and equalization
+  alignas(64) AlignedArray<T, OUTPUTS, 32> output;
+  EqualizerFilter<double, CHANNELS_PER_GROUP> filters_[GROUPS + 1];
+  // Limiting
+  alignas(64) Limiters limiter;
+  TruePeakDetector<T, CHANNELS_PER_GROUP> groupTruePeak[GROUPS];
+  TruePeakDetector<T, 1> subTruePeak;
+  bool useTruePeak = false;
+  LimiterFaultCapture<LIMITERS> faultCapture;
+
+  /*
+   * State only used when (re)configuring.
+   */
+  // Prepared for the next sample rate
+  alignas(64) std::unique_ptr<RateBuffers> prepared_;
+  // Previously used, kept to switch back without allocating
+  std::unique_ptr<RateBuffers> spare_;
+  // Locked areas to allocate buffers in, or none to use the heap
+  std::unique_ptr<BufferArea> areas_[2];
+  FixedSizeArray<T, BANDS> relativeBandWeights;
+  double noiseAvg = 0;
+  IntegrationCoefficients<double> noiseIntegrator;
+  IntegrationCoefficients<T> limiterRelease;
   T sampleRate_;
   bool bypass = true;
 
@@ -206,48 +412,107 @@ private:
   static constexpr double PERCEIVED_SLOW_BURST_POWER = 0.15;
 
 public:
-  DynamicProcessorLevels levels;
+  PeriodLevels periodLevels;
 
-  DynamicsProcessor()
-      : noise(1.0, 9600), groupDetector(new DetectorGroup[DETECTORS]),
-        sampleRate_(0), levels(GROUPS) {
-    levels.reset();
+  DynamicsProcessor() : noise(1.0, 9600), sampleRate_(0) {
+    periodLevels.start(0, LIMITERS);
   }
 
-  ~DynamicsProcessor() { delete[] groupDetector; }
+  ~DynamicsProcessor() {
+    // Buffers must be freed before the areas they were allocated in
+    buffers_.reset();
+    prepared_.reset();
+    spare_.reset();
+  }
 
-  void setSampleRate(T sampleRate,
-                     const FixedSizeArray<T, CROSSOVERS> &crossovers,
-                     const SpeakermanConfig &config) {
-    noiseAvg = 0.0;
-    noiseIntegrator.setCharacteristicSamples(sampleRate / 20);
-    aCurve.setSampleRate(sampleRate);
-    crossoverFilter.configure(sampleRate, crossovers);
-    // Rms detector confiuration
+  /**
+   * Starts collecting the levels for a new processing period.
+   */
+  void startPeriod(uint64_t period) noexcept {
+    periodLevels.start(period, LIMITERS);
+  }
+
+  /**
+   * Reserves two locked and pre-faulted areas that each fit the buffers of the
+   * highest supported sample rate, and allocates sample rate buffers in those
+   * instead of on the heap. At most two sets of buffers are alive when
+   * allocating: those in use and the new ones. An area is reused once the
+   * buffers in it are freed, so changing the sample rate never allocates
+   * outside locked memory.
+   */
+  void reserveBufferMemory() {
+    size_t bytes = measureBufferAreaBytes();
+    for (auto &area : areas_) {
+      if (!area) {
+        area = std::make_unique<BufferArea>(bytes);
+      }
+    }
+    std::cout << "Sample buffer areas: 2 x " << bytes / 1024 << " kB"
+              << std::endl;
+  }
+
+  /**
+   * Prepares detectors, delays and band weights for the sample rate, without
+   * touching anything that is used by processing, so this can be done while
+   * processing still goes on. Buffers of the previous sample rate are reused
+   * if they have the right size and detectors are configured in parallel, as
+   * filling their histories is the bulk of the work.
+   */
+  void prepareSampleRate(T sampleRate,
+                         const FixedSizeArray<T, CROSSOVERS> &crossovers,
+                         const SpeakermanConfig &config) {
+    std::unique_ptr<RateBuffers> buffers =
+        takeBuffers(BufferPlan::forSampleRate(sampleRate));
+    buffers->delays.zero();
+    buffers->rmsDelay.zero();
     DetectionConfig detection = config.detection;
     Perceptive::Metrics perceptiveMetrics =
         Perceptive::Metrics::createWithEvenSteps(
             detection.maximum_window_seconds, detection.minimum_window_seconds,
             std::min(RMS_DETECTION_LEVELS, detection.perceptive_levels));
-//    std::cout << perceptiveMetrics << std::endl;
-    subDetector.configure(sampleRate, perceptiveMetrics, 100);
-    for (size_t band = 0, detector = 0; band < CROSSOVERS; band++) {
-      for (size_t group = 0; group < GROUPS; group++, detector++) {
-        groupDetector[detector].configure(sampleRate, perceptiveMetrics, 100);
-      }
-    }
-    size_t rmsLatency = groupDetector[0].getLatency();
-    rmsDelay.setDelay(rmsLatency);
-    std::cout << "RMS detection prediction=" << rmsLatency << std::endl;
+    configureDetectors(*buffers, sampleRate, perceptiveMetrics);
+
     auto weights = Crossovers::weights(crossovers, sampleRate);
     cout << "Band weights: sub=" << weights[0];
-    relativeBandWeights[0] = weights[0];
+    buffers->bandWeights[0] = weights[0];
     for (size_t band = 1; band <= CROSSOVERS; band++) {
       const T &bw = weights[2 * band + 1];
       cout << " band-" << band << "=" << bw;
-      relativeBandWeights[band] = bw;
+      buffers->bandWeights[band] = bw;
     }
     cout << endl;
+    buffers->sampleRate = sampleRate;
+    buffers->detection = detection;
+    buffers->crossovers = crossovers;
+    prepared_ = std::move(buffers);
+  }
+
+  /**
+   * Sets the sample rate, using what was prepared with prepareSampleRate() or
+   * preparing it first. The configuration can have changed since it was
+   * prepared, so prepared buffers are only used if they were prepared for the
+   * same sample rate, crossovers and detection. This must be called while not
+   * processing.
+   */
+  void setSampleRate(T sampleRate,
+                     const FixedSizeArray<T, CROSSOVERS> &crossovers,
+                     const SpeakermanConfig &config) {
+    if (!prepared_ ||
+        !prepared_->preparedFor(sampleRate, crossovers, config.detection)) {
+      prepareSampleRate(sampleRate, crossovers, config);
+    }
+    spare_ = std::move(buffers_);
+    buffers_ = std::move(prepared_);
+    relativeBandWeights = buffers_->bandWeights;
+
+    noiseAvg = 0.0;
+    noiseIntegrator.setCharacteristicSamples(sampleRate / 20);
+    aCurve.setSampleRate(sampleRate);
+    crossoverFilter.configure(sampleRate, crossovers);
+    DetectionConfig detection = config.detection;
+    size_t rmsLatency = buffers_->detectors.group(0).getLatency();
+    buffers_->rmsDelay.setDelay(rmsLatency);
+    std::cout << "RMS detection prediction=" << rmsLatency << std::endl;
     size_t predictionSamples = 0.5 + sampleRate * LIMITER_PREDICTION_SECONDS;
     limiterRelease.setCharacteristicSamples(10 * predictionSamples);
     printf("Prediction samples: %zu for rate %lf\n", predictionSamples,
@@ -256,16 +521,108 @@ public:
         predictionSamples, peakThreshold, sampleRate,
         detection.useBrickWallPrediction == 1 ? LimiterClass::SMOOTH_TRIANGULAR
                                               : LimiterClass::CRUDE);
+    useTruePeak = detection.useTruePeak == 1;
     size_t latency = limiter.getLatency();
-    for (size_t l = 0; l < DELAY_CHANNELS; l++) {
-      predictionDelay.setDelay(l, latency);
+    if (useTruePeak) {
+      // The true-peak estimate lags the signal, which needs extra delay
+      latency += TruePeakDetector<T, 1>::LATENCY;
+      subTruePeak.reset();
+      for (size_t group = 0; group < GROUPS; group++) {
+        groupTruePeak[group].reset();
+      }
     }
+    std::cout << "True-peak detection: " << (useTruePeak ? "on" : "off")
+              << std::endl;
+    buffers_->delays.setLimiterLatency(latency);
+    faultCapture.configure(sampleRate, peakThreshold, latency);
     sampleRate_ = sampleRate;
     runtime.init(createConfigData(config));
     noise.setScale(runtime.userSet().noiseScale());
     noise.setIntegrationSamples(sampleRate_ * 0.05);
   }
 
+private:
+  /**
+   * Returns buffers with the exact sizes of the plan, from those that were
+   * prepared or used before if possible.
+   */
+  std::unique_ptr<RateBuffers> takeBuffers(const BufferPlan &plan) {
+    if (prepared_ && prepared_->plan == plan) {
+      return std::move(prepared_);
+    }
+    if (spare_ && spare_->plan == plan) {
+      return std::move(spare_);
+    }
+    // Free memory that has the wrong size before allocating
+    prepared_.reset();
+    spare_.reset();
+    std::unique_ptr<RateBuffers> buffers;
+    if (areas_[0]) {
+      consecutive_alloc::Enable guard = freeBufferArea().enable();
+      buffers = std::make_unique<RateBuffers>(plan);
+    } else {
+      buffers = std::make_unique<RateBuffers>(plan);
+    }
+    long long reference =
+        BufferPlan::forSampleRate(REFERENCE_SAMPLE_RATE).bytes();
+    long long used = plan.bytes();
+    std::cout << "Sample buffers for plan: " << used / 1024 << " kB; saved "
+              << (reference - used) / 1024 << " kB compared to "
+              << REFERENCE_SAMPLE_RATE << " Hz" << std::endl;
+    return buffers;
+  }
+
+  BufferArea &freeBufferArea() {
+    for (auto &area : areas_) {
+      if (area->reuse()) {
+        return *area;
+      }
+    }
+    throw std::logic_error(
+        "DynamicsProcessor: no free sample buffer area");
+  }
+
+  /**
+   * Returns the number of bytes that the buffers of the highest supported
+   * sample rate allocate, by creating them in a lazily mapped block.
+   */
+  static size_t measureBufferAreaBytes() {
+    const BufferPlan plan = BufferPlan::forSampleRate(REFERENCE_SAMPLE_RATE);
+    for (size_t blockSize = 2 * (sizeof(RateBuffers) + plan.bytes());;
+         blockSize *= 2) {
+      tdap::ConsecutiveAllocationOwner measure(blockSize, false);
+      {
+        consecutive_alloc::Enable guard = measure.enable();
+        std::make_unique<RateBuffers>(plan).reset();
+      }
+      if (measure.is_consecutive()) {
+        return measure.get_allocated_bytes();
+      }
+    }
+  }
+
+  static void configureDetectors(RateBuffers &buffers, T sampleRate,
+                                 const Perceptive::Metrics &metrics) {
+    static constexpr size_t COUNT = Detectors::size();
+    Detectors &detectors = buffers.detectors;
+    size_t workers = Sizes::force_between(std::thread::hardware_concurrency(),
+                                          1, COUNT);
+    auto configure = [&](size_t worker) {
+      for (size_t i = worker; i < COUNT; i += workers) {
+        detectors[i].configure(sampleRate, metrics, 100);
+      }
+    };
+    std::vector<std::future<void>> work;
+    for (size_t worker = 1; worker < workers; worker++) {
+      work.push_back(std::async(std::launch::async, configure, worker));
+    }
+    configure(0);
+    for (auto &result : work) {
+      result.get();
+    }
+  }
+
+public:
   const ConfigData &getConfigData() const { return runtime.userSet(); }
 
   ConfigData createConfigData(const SpeakermanConfig &config) {
@@ -274,8 +631,31 @@ public:
     return data;
   }
 
-  void updateConfig(const ConfigData &data) {
-    runtime.modify(data);
+  /**
+   * Reconfigures data that was created from the previous configuration, for
+   * the differences with the new one.
+   * @return the parts that changed, to be applied with updateConfig()
+   */
+  unsigned reconfigureData(ConfigData &data, const SpeakermanConfig &previous,
+                           const SpeakermanConfig &config) {
+    return data.reconfigure(previous, config, sampleRate_, relativeBandWeights,
+                            0.25 / 1.5);
+  }
+
+  void updateConfig(const ConfigData &data,
+                    unsigned parts = RuntimeDataParts::ALL) {
+    runtime.modify(data, parts);
+    for (size_t group = 0; group < GROUPS; group++) {
+      if (parts & RuntimeDataParts::groupFilter(group)) {
+        filters_[group].configure(data.groupConfig(group).filterConfig());
+      }
+    }
+    if (parts & RuntimeDataParts::SUB_FILTER) {
+      filters_[GROUPS].configure(data.filterConfig());
+    }
+    if ((parts & RuntimeDataParts::LEVELS) == 0) {
+      return;
+    }
     noise.setScale(data.noiseScale());
     size_t predictionSamples = 0.5 + sampleRate_ * LIMITER_PREDICTION_SECONDS;
     size_t subDelay = data.subDelay();
@@ -289,15 +669,13 @@ public:
     }
 
     for (size_t group = 0, i = 1; group < GROUPS; group++) {
-      filters_[group].configure(data.groupConfig(group).filterConfig());
       size_t groupDelaySamples =
           data.groupConfig(group).delay() - minGroupDelay;
       for (size_t channel = 0; channel < CHANNELS_PER_GROUP; channel++, i++) {
-        groupDelay.setDelay(i, groupDelaySamples);
+        buffers_->delays.setChannelDelay(i, groupDelaySamples);
       }
     }
-    groupDelay.setDelay(0, subDelay - minGroupDelay);
-    filters_[GROUPS].configure(data.filterConfig());
+    buffers_->delays.setChannelDelay(0, subDelay - minGroupDelay);
   }
 
   void process(const AlignedArray<T, LOGICAL_INPUTS, 32> &input,
@@ -307,13 +685,26 @@ public:
     moveToProcessingChannels(crossoverFilter.filter(inputWithVolumeAndNoise));
     processSubRms();
     processChannelsRms();
-    levels.next();
+    periodLevels.frames++;
     mergeFrequencyBands();
-    processChannelsFilters(target);
-    processSubLimiter(target);
-    groupDelay.next();
-    predictionDelay.next();
-    rmsDelay.next();
+    if (limiter.limiterClass() == LimiterClass::SMOOTH_TRIANGULAR) {
+      processChannelsFilters(target, limiter.smooth());
+      processSubLimiter(target, limiter.smooth());
+    } else {
+      processChannelsFilters(target, limiter.crude());
+      processSubLimiter(target, limiter.crude());
+    }
+    buffers_->delays.next();
+    buffers_->rmsDelay.next();
+    faultCapture.next();
+  }
+
+  /**
+   * Fetches the oldest captured limiter fault, if any. This can be called
+   * from any single non-processing thread.
+   */
+  bool fetchLimiterFault(LimiterFaultSnapshot &snapshot) {
+    return faultCapture.fetch(snapshot);
   }
 
 private:
@@ -347,21 +738,22 @@ private:
     T x = processInput[0];
     T sub = x;
     x *= runtime.data().subRmsScale();
-    T detect = subDetector.add_square_get_detection(x * x, 1.0);
+    T detect = buffers_->detectors.sub().add_square_get_detection(x * x, 1.0);
     T gain = 1.0 / detect;
-    levels.addValues(0, detect);
-    sub = gain * rmsDelay.setAndGet(0, sub);
+    periodLevels.addRms(0, detect);
+    sub = gain * buffers_->rmsDelay.setAndGet(0, sub);
     processInput[0] = filters_[GROUPS].filter()->filter(0, sub);
   }
 
   void processChannelsRms() {
+    RmsDelay &rmsDelay = buffers_->rmsDelay;
     for (size_t band = 0, delay = 1, baseOffset = 1, detector = 0;
          band < CROSSOVERS; band++) {
       for (size_t group = 0; group < GROUPS; group++, detector++) {
         T scaleForUnity =
             runtime.data().groupConfig(group).bandRmsScale(1 + band);
         size_t nextOffset = baseOffset + CHANNELS_PER_GROUP;
-        DetectorGroup &gd = groupDetector[detector];
+        DetectorGroup &gd = buffers_->detectors.group(detector);
         T squareSum = 0.0;
         for (size_t offset = baseOffset, channel = 0; offset < nextOffset;
              offset++, delay++, channel++) {
@@ -372,7 +764,7 @@ private:
         }
         T detect = gd.add_square_get_detection(squareSum, 1.0);
         T gain = 1.0 / detect;
-        levels.addValues(1 + group, detect);
+        periodLevels.addRms(1 + group, detect);
         for (size_t offset = baseOffset; offset < nextOffset; offset++) {
           processInput[offset] =
               gain * rmsDelay.setAndGet(offset, processInput[offset]);
@@ -416,73 +808,10 @@ private:
     }
   }
 
-#ifdef DYNAMICS_PROCESSOR_LIMITER_ANALYSIS
-  struct Analysis {
-    const T decay = exp(-1.0 / 1000000);
-    const T multiply = 1.0 - decay;
-    static constexpr size_t HISTORY = 1000;
-    static constexpr size_t MAXCOUNT = 2 * HISTORY;
-    int counter = -1;
-    T square = 0.0;
-    T maxRms = 0.0;
-    T maxPeak = 0.0;
-    T maxMaxRms = 0.0;
-    T maxMaxPeak = 0.0;
-    T signalPeak = numeric_limits<T>::lowest();
-    T signalDetection = numeric_limits<T>::lowest();
-    T limiterGain = numeric_limits<T>::max();
-    size_t peakCount = 0;
-    size_t peakRmsCount = 0;
-    size_t peakGreaterThanDetectionCount = 0;
-    T peakHistory[HISTORY];
-    T detectHistory[HISTORY];
-    T delayedHistory[HISTORY];
-    size_t historyPointer = 0;
-
-    void analyseTarget(FixedSizeArray<T, OUTPUTS> &target, size_t offs_start,
-                       T prePeak, T detection, size_t delay) {
-      T maxOut = 0;
-      for (size_t channel = 0, offs = offs_start; channel < CHANNELS_PER_GROUP;
-           channel++) {
-        maxOut = Floats::max(maxOut, fabs(target[offs]));
-      }
-      peakHistory[historyPointer] = prePeak;
-      detectHistory[historyPointer] = maxOut;
-      T delayedInput =
-          peakHistory[(historyPointer + HISTORY - delay) % HISTORY];
-      delayedHistory[historyPointer] = delayedInput;
-      bool fault = maxOut > peakThreshold;
-
-      if (fault && counter == -1) {
-        printf("SAMPLE\tPEAK\tDETECTION\tFAULT\n");
-        counter = 0;
-        for (size_t i = historyPointer; counter < HISTORY;
-             counter++, i = (i + 1) % HISTORY) {
-          //                        printf("%i\t%lf\t%lf\t%s\n", counter,
-          //                        peakHistory[i], detectHistory[i],
-          //                        peakHistory[i] > detectHistory[i] ? "FAULT"
-          //                        : "");
-          printf("%i\t%lf\t%lf\t%8s %zu\n", counter, peakHistory[i],
-                 detectHistory[i],
-                 detectHistory[historyPointer] > peakThreshold ? "FAULT" : "",
-                 delay);
-        }
-      }
-      if (counter >= 0 && counter < MAXCOUNT) {
-        printf("%i\t%lf\t%lf\t%8s %zu\n", counter, prePeak, maxOut,
-               fault ? "FAULT" : "", delay);
-        counter++;
-      }
-      historyPointer = (historyPointer + 1) % HISTORY;
-    }
-  } analysis;
-
-#define DO_DYNAMICS_PROCESSOR_LIMITER_ANALYSIS(TARGET, OFFS, MAX, DETECT, OUT) \
-  analysis.analyseTarget(TARGET, OFFS, MAX, DETECT, OUT)
-#else
-#define DO_DYNAMICS_PROCESSOR_LIMITER_ANALYSIS(TARGET, OFFS, MAX, DETECT, GAIN)
-#endif
-  void processChannelsFilters(FixedSizeArray<T, OUTPUTS> &target) {
+  template <class GroupLimiter>
+  void processChannelsFilters(FixedSizeArray<T, OUTPUTS> &target,
+                              GroupLimiter *limiters) {
+    DelayPlan &delays = buffers_->delays;
 
     for (size_t group = 0, offs_start = 1; group < GROUPS;
          group++, offs_start += CHANNELS_PER_GROUP) {
@@ -491,30 +820,48 @@ private:
       T maxFiltered = 0;
       for (size_t channel = 0, offs = offs_start; channel < CHANNELS_PER_GROUP;
            channel++, offs++) {
-        double out =
-            filter->filter(channel, groupDelay.setAndGet(offs, output[offs]));
+        delays.set(offs, filter->filter(channel, output[offs]));
+        T out = delays.detection(offs);
         maxFiltered = Floats::max(maxFiltered, fabs(out));
-        target[offs] = predictionDelay.setAndGet(offs, out);
+        target[offs] = delays.limiterInput(offs);
+        if (useTruePeak) {
+          groupTruePeak[group].add(channel, out);
+        }
       }
-      T limiterGain = limiter.getGain(group, maxFiltered);
+      if (useTruePeak) {
+        maxFiltered = groupTruePeak[group].next();
+      }
+      T limiterGain = limiters[1 + group].getGain(maxFiltered);
+      T maxOutput = 0;
       for (size_t channel = 0, offs = offs_start; channel < CHANNELS_PER_GROUP;
            channel++, offs++) {
         T outputValue = target[offs] * limiterGain;
         target[offs] = outputValue;
-        // Floats::force_between(outputValue,-peakThreshold, peakThreshold);
+        maxOutput = Floats::max(maxOutput, fabs(outputValue));
       }
-      DO_DYNAMICS_PROCESSOR_LIMITER_ANALYSIS(target, offs_start, maxFiltered,
-                                             limiterGain,
-                                             predictionDelay.getDelay(0));
+      periodLevels.addPeakAndGain(1 + group, maxFiltered, limiterGain);
+      faultCapture.add(1 + group, maxFiltered, limiterGain, maxOutput);
     }
   }
 
-  void processSubLimiter(FixedSizeArray<T, OUTPUTS> &target) {
-    T value = output[0];
-    T maxOut = fabs(value);
-    T limiterGain = limiter.getGain(0, maxOut);
-    target[0] = groupDelay.setAndGet(
-        0, limiterGain * predictionDelay.setAndGet(0, value));
+  template <class SubLimiter>
+  void processSubLimiter(FixedSizeArray<T, OUTPUTS> &target,
+                         SubLimiter *limiters) {
+    DelayPlan &delays = buffers_->delays;
+    delays.set(0, output[0]);
+    T value = delays.detection(0);
+    T maxOut;
+    if (useTruePeak) {
+      subTruePeak.add(0, value);
+      maxOut = subTruePeak.next();
+    } else {
+      maxOut = fabs(value);
+    }
+    T limiterGain = limiters[0].getGain(maxOut);
+    T limited = limiterGain * delays.limiterInput(0);
+    periodLevels.addPeakAndGain(0, maxOut, limiterGain);
+    faultCapture.add(0, maxOut, limiterGain, fabs(limited));
+    target[0] = limited;
   }
 };
 
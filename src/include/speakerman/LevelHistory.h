@@ -0,0 +1,128 @@
+#ifndef SPEAKERMAN_M_LEVEL_HISTORY_H
+#define SPEAKERMAN_M_LEVEL_HISTORY_H
+/*
+ * speakerman/LevelHistory.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <speakerman/DynamicProcessorLevels.h>
+#include <vector>
+
+namespace speakerman {
+
+/**
+ * Minimum, maximum and sum of the values that were added to a bucket.
+ */
+struct LevelStatistic {
+  float minimum;
+  float maximum;
+  float sum;
+
+  void start(float value) { minimum = maximum = sum = value; }
+
+  void add(float value) {
+    minimum = Values::min(minimum, value);
+    maximum = Values::max(maximum, value);
+    sum += value;
+  }
+};
+
+/**
+ * Level, peak and gain statistics of a time bucket, for the sub (index zero)
+ * and each group.
+ */
+struct LevelHistoryBucket {
+  static constexpr size_t MAX_LEVELS = PeriodLevels::MAX_LEVELS;
+
+  // Start of the bucket in seconds since the epoch, zero if unused
+  int64_t start;
+  uint32_t samples;
+  uint32_t levels;
+  LevelStatistic level[MAX_LEVELS];
+  LevelStatistic peak[MAX_LEVELS];
+  LevelStatistic gain[MAX_LEVELS];
+
+  void add(int64_t bucketStart, const DynamicProcessorLevels &values);
+};
+
+/**
+ * Keeps levels of the last hour per second and of the last week per minute in
+ * a fixed amount of memory. The buckets are mapped from a file, so that the
+ * history survives restarts; if that file cannot be used, the history is only
+ * kept in memory.
+ */
+class LevelHistory {
+public:
+  static constexpr size_t SECOND_BUCKETS = 3600;
+  static constexpr size_t MINUTE_BUCKETS = 7 * 24 * 60;
+
+  enum class Resolution { Seconds, Minutes };
+
+  /**
+   * Opens the history from the file, or creates it.
+   * @param fileName The file or nullptr to keep the history in memory
+   */
+  explicit LevelHistory(const char *fileName);
+
+  LevelHistory(const LevelHistory &) = delete;
+
+  ~LevelHistory();
+
+  /**
+   * Adds levels that were measured at the given time.
+   * @param stamp Time in milliseconds since the epoch.
+   */
+  void add(long long stamp, const DynamicProcessorLevels &levels);
+
+  /**
+   * Replaces output with the kept buckets that start within the given range
+   * of seconds since the epoch, oldest first.
+   */
+  void query(int64_t from, int64_t to, Resolution resolution,
+             std::vector<LevelHistoryBucket> &output);
+
+  /**
+   * Returns the bucket duration in seconds for the resolution.
+   */
+  static int64_t seconds(Resolution resolution) {
+    return resolution == Resolution::Seconds ? 1 : 60;
+  }
+
+  bool persistent() const { return persistent_; }
+
+private:
+  struct Header;
+
+  std::mutex m;
+  void *mapping_ = nullptr;
+  size_t mappingBytes_ = 0;
+  bool persistent_ = false;
+  LevelHistoryBucket *seconds_ = nullptr;
+  LevelHistoryBucket *minutes_ = nullptr;
+
+  static size_t historyBytes();
+  bool mapFile(const char *fileName);
+  bool mapMemory();
+};
+
+} // namespace speakerman
+
+#endif // SPEAKERMAN_M_LEVEL_HISTORY_H
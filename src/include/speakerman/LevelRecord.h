@@ -0,0 +1,112 @@
+#ifndef SPEAKERMAN_M_LEVEL_RECORD_H
+#define SPEAKERMAN_M_LEVEL_RECORD_H
+/*
+ * speakerman/LevelRecord.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <speakerman/DynamicProcessorLevels.h>
+#include <string>
+
+namespace speakerman {
+
+/**
+ * Levels of one update in a fixed binary layout, for meters that poll at a
+ * high rate and for consumers that are not browsers. Integers are unsigned
+ * and all fields are little-endian. Levels are IEEE-754 single precision.
+ *
+ * offset  size  field
+ *      0     8  sequence
+ *      8     8  stamp in milliseconds since the epoch
+ *     16     4  number of processed frames
+ *     20     2  number of valid levels: the sub and the groups
+ *     22     2  reserved
+ *     24     4  threshold scale
+ *     28     4  long-term CPU percentage
+ *     32     4  short-term CPU percentage
+ *     36     4  reserved
+ *     40    12  level, peak and gain of the sub, then of each group, where
+ *               MAX_LEVELS are present and unused ones are zero.
+ */
+struct LevelRecord {
+  static constexpr size_t MAX_LEVELS = PeriodLevels::MAX_LEVELS;
+  static constexpr size_t HEADER_BYTES = 40;
+  static constexpr size_t LEVEL_BYTES = 12;
+  static constexpr size_t BYTES = HEADER_BYTES + MAX_LEVELS * LEVEL_BYTES;
+
+  uint8_t bytes[BYTES];
+
+  void set(uint64_t sequence, long long stamp,
+           const DynamicProcessorLevels &levels, double thresholdScale,
+           double cpuLongTerm, double cpuShortTerm);
+
+  uint64_t sequence() const;
+};
+
+/**
+ * Keeps the most recent level records, so that clients can fetch the records
+ * they did not see yet.
+ *
+ * A reply consists of a header, followed by the records, oldest first. The
+ * header is little-endian as well.
+ *
+ * offset  size  field
+ *      0     4  magic "SPKL"
+ *      4     2  version
+ *      6     2  record size in bytes
+ *      8     4  number of records
+ *     12     2  levels per record
+ *     14     2  reserved
+ */
+class LevelRecordRing {
+public:
+  static constexpr size_t SIZE = 256;
+  static constexpr size_t REPLY_HEADER_BYTES = 16;
+  static constexpr uint16_t VERSION = 1;
+
+  void put(const LevelRecord &record);
+
+  /**
+   * Replaces output with a reply that contains the records with a sequence
+   * after the given one that are still kept. Sequences restart with each run,
+   * so a sequence after the latest one gets the latest record instead.
+   * @return the number of records.
+   */
+  size_t writeSince(uint64_t sequence, std::string &output);
+
+  /**
+   * Replaces output with a reply that contains only the latest record, if
+   * any.
+   * @return the number of records.
+   */
+  size_t writeLatest(std::string &output);
+
+private:
+  std::mutex m;
+  LevelRecord records[SIZE] = {};
+  uint64_t latest_ = 0;
+
+  size_t write(uint64_t first, std::string &output);
+};
+
+} // namespace speakerman
+
+#endif // SPEAKERMAN_M_LEVEL_RECORD_H
@@ -0,0 +1,191 @@
+#ifndef SPEAKERMAN_M_LIMITER_FAULT_CAPTURE_H
+#define SPEAKERMAN_M_LIMITER_FAULT_CAPTURE_H
+/*
+ * speakerman/LimiterFaultCapture.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+
+namespace speakerman {
+
+struct LimiterAnalysisEntry {
+  float peak;
+  float gain;
+  float output;
+};
+
+/**
+ * History of a limiter around a fault: a sample where the limited output
+ * exceeded the threshold. The fault is at PRE_SAMPLES - 1.
+ */
+struct LimiterFaultSnapshot {
+  static constexpr size_t PRE_SAMPLES = 1024;
+  static constexpr size_t POST_SAMPLES = 1024;
+  static constexpr size_t SAMPLES = PRE_SAMPLES + POST_SAMPLES;
+
+  unsigned long long sequence = 0;
+  unsigned long long faultSample = 0;
+  size_t limiter = 0;
+  size_t latency = 0;
+  double sampleRate = 0;
+  double threshold = 0;
+  LimiterAnalysisEntry entry[SAMPLES];
+
+  /**
+   * Writes the snapshot as CSV, with a comment line that describes the
+   * limiter and samples numbered relative to the fault.
+   */
+  void writeCsv(std::ostream &out) const;
+};
+
+/**
+ * Always-on fault capture for a number of limiters, where limiter zero is the
+ * sub and the rest are the groups.
+ *
+ * The processing thread adds the peak, gain and output of each limiter for
+ * each sample. This is written into a small history ring per limiter. When
+ * the output of a limiter exceeds the threshold, its history becomes the
+ * pre-fault window of a free snapshot, after which the post-fault window is
+ * recorded. Snapshots are preallocated and handed over with an atomic state,
+ * so neither side locks or allocates. When no snapshot is free, or while
+ * another limiter is captured, faults are only counted.
+ */
+template <size_t LIMITERS> class LimiterFaultCapture {
+  static constexpr size_t PRE_SAMPLES = LimiterFaultSnapshot::PRE_SAMPLES;
+  static constexpr size_t HISTORY_MASK = PRE_SAMPLES - 1;
+  static constexpr size_t SLOTS = 4;
+  static_assert((PRE_SAMPLES & HISTORY_MASK) == 0,
+                "Pre-fault window must be a power of two");
+
+  enum State { FREE, CAPTURING, READY, READING };
+
+  struct Slot {
+    std::atomic<int> state = FREE;
+    size_t written = 0;
+    LimiterFaultSnapshot snapshot;
+  };
+
+  LimiterAnalysisEntry history_[LIMITERS][PRE_SAMPLES];
+  Slot slots_[SLOTS];
+  Slot *capturing_ = nullptr;
+  unsigned long long position_ = 0;
+  unsigned long long sequence_ = 0;
+  std::atomic<unsigned long long> missed_ = 0;
+  double sampleRate_ = 0;
+  double threshold_ = 1.0;
+  size_t latency_ = 0;
+
+  void startCapture(size_t limiter) noexcept {
+    for (Slot &slot : slots_) {
+      if (slot.state.load(std::memory_order_acquire) == FREE) {
+        LimiterFaultSnapshot &snapshot = slot.snapshot;
+        snapshot.sequence = ++sequence_;
+        snapshot.faultSample = position_;
+        snapshot.limiter = limiter;
+        snapshot.latency = latency_;
+        snapshot.sampleRate = sampleRate_;
+        snapshot.threshold = threshold_;
+        // oldest first, ending with the current sample
+        size_t start = (position_ + 1) & HISTORY_MASK;
+        size_t first = PRE_SAMPLES - start;
+        memcpy(snapshot.entry, history_[limiter] + start,
+               first * sizeof(LimiterAnalysisEntry));
+        memcpy(snapshot.entry + first, history_[limiter],
+               start * sizeof(LimiterAnalysisEntry));
+        slot.written = PRE_SAMPLES;
+        slot.state.store(CAPTURING, std::memory_order_relaxed);
+        capturing_ = &slot;
+        return;
+      }
+    }
+    missed_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+public:
+  /**
+   * Resets the capture for new processing metrics. This must not be called
+   * while processing.
+   */
+  void configure(double sampleRate, double threshold, size_t latency) {
+    sampleRate_ = sampleRate;
+    threshold_ = threshold;
+    latency_ = latency;
+    memset(history_, 0, sizeof(history_));
+    if (capturing_) {
+      capturing_->state.store(FREE, std::memory_order_release);
+      capturing_ = nullptr;
+    }
+  }
+
+  inline void add(size_t limiter, double peak, double gain,
+                  double output) noexcept {
+    LimiterAnalysisEntry &entry =
+        history_[limiter][position_ & HISTORY_MASK];
+    entry = {float(peak), float(gain), float(output)};
+    if (capturing_) {
+      if (capturing_->snapshot.limiter == limiter) {
+        capturing_->snapshot.entry[capturing_->written++] = entry;
+        if (capturing_->written == LimiterFaultSnapshot::SAMPLES) {
+          capturing_->state.store(READY, std::memory_order_release);
+          capturing_ = nullptr;
+        }
+      } else if (output > threshold_) {
+        missed_.fetch_add(1, std::memory_order_relaxed);
+      }
+    } else if (output > threshold_) {
+      startCapture(limiter);
+    }
+  }
+
+  inline void next() noexcept { position_++; }
+
+  /**
+   * Copies the oldest completed snapshot and makes its slot available again.
+   * This is meant for a single background reader.
+   * @return true if there was a completed snapshot
+   */
+  bool fetch(LimiterFaultSnapshot &target) {
+    Slot *oldest = nullptr;
+    for (Slot &slot : slots_) {
+      if (slot.state.load(std::memory_order_acquire) == READY &&
+          (!oldest || slot.snapshot.sequence < oldest->snapshot.sequence)) {
+        oldest = &slot;
+      }
+    }
+    if (!oldest) {
+      return false;
+    }
+    oldest->state.store(READING, std::memory_order_relaxed);
+    target = oldest->snapshot;
+    oldest->state.store(FREE, std::memory_order_release);
+    return true;
+  }
+
+  unsigned long long missed() const {
+    return missed_.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace speakerman
+
+#endif // SPEAKERMAN_M_LIMITER_FAULT_CAPTURE_H
@@ -27,6 +27,11 @@
 
 namespace speakerman {
 
+/**
+ * Contents of a file, that is re-read when the file changed, checked at most
+ * once per second. Besides the contents, it keeps a strong ETag and a gzip
+ * compressed variant, so that the file can be served from memory.
+ */
 class file_entry : public input_stream {
   std::string name_;
   char *data_ = nullptr;
@@ -35,12 +40,37 @@ class file_entry : public input_stream {
   size_t readPos_ = 0;
   long long fileStamp_;
   long long lastChecked_;
+  std::string etag_;
+  std::string gzipped_;
 
 public:
   file_entry(const char *name);
 
+  file_entry(const char *directory, const char *name);
+
+  /**
+   * Re-reads the file if it changed and resets the read position.
+   */
   void reset();
 
+  const char *data() const { return data_; }
+
+  /**
+   * Returns the strong ETag, including quotes, of the current contents.
+   */
+  const std::string &etag() const { return etag_; }
+
+  /**
+   * Returns the gzip compressed contents, which is empty if compression did
+   * not make the contents smaller.
+   */
+  const std::string &gzipped() const { return gzipped_; }
+
+  /**
+   * Returns the MIME type derived from the file extension.
+   */
+  const char *contentType() const;
+
   virtual int read();
 
   virtual signed long read(void *buff, size_t offs, size_t length);
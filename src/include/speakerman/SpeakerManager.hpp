@@ -35,12 +35,28 @@
 #include <tdap/IirButterworth.hpp>
 #include <tdap/MemoryFence.hpp>
 #include <tdap/Noise.hpp>
+#include <tdap/SpscRing.hpp>
+#include <tdap/Transport.hpp>
 #include <tdap/Weighting.hpp>
 
 namespace speakerman {
 
 class AbstractSpeakerManager : public SpeakerManagerControl,
-                               public jack::JackProcessor {};
+                               public jack::JackProcessor {
+public:
+  /**
+   * Reserves locked memory for the buffers that depend on the sample rate,
+   * that is large enough for any supported sample rate and reused when the
+   * sample rate changes.
+   */
+  virtual void reserveBufferMemory() = 0;
+
+  /**
+   * Allocates and prepares the buffers for the sample rate, so that processing
+   * can start at that rate without allocating.
+   */
+  virtual void prepareBuffers(double sampleRate) = 0;
+};
 
 template <typename T, size_t CHANNELS_PER_GROUP, size_t GROUPS,
           size_t CROSSOVERS, size_t LOGICAL_INPUTS>
@@ -52,7 +68,6 @@ class SpeakerManager : public AbstractSpeakerManager {
       DynamicsProcessor<T, CHANNELS_PER_GROUP, GROUPS, CROSSOVERS, LOGICAL_INPUTS>;
   using CrossoverFrequencies = typename Processor::CrossoverFrequencies;
   using ThresholdValues = typename Processor::ThresholdValues;
-  using Levels = DynamicProcessorLevels;
   using ConfigData = typename Processor::ConfigData;
 
   static constexpr size_t OUTPUTS = Processor::OUTPUTS;
@@ -89,33 +104,38 @@ class SpeakerManager : public AbstractSpeakerManager {
   bool fewerInputs = false;
   bool fewerOutputs = false;
 
-  struct TransportData {
-    ConfigData configData;
-    Levels levels;
-    bool configChanged;
-
-    TransportData() : levels(GROUPS), configChanged(false) {}
+  struct ConfigUpdate {
+    unsigned parts;
+    ConfigData data;
   };
 
-  Transport<TransportData> transport;
-  TransportData preparedConfigData;
+  Transport<ConfigUpdate> transport;
+  // Only used by the configuring side, under mutex_
+  ConfigData preparedData_;
+  unsigned unappliedParts_ = 0;
+  uint32_t unappliedSequence_ = 0;
+  SpscRing<PeriodLevels, 1024> levelRing;
+  uint64_t period = 0;
 
 protected:
   const jack::PortDefinitions &getDefinitions() override {
     return portDefinitions_;
   }
 
+  void onPrepareMetrics(jack::ProcessingMetrics metrics) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    processor.prepareSampleRate(metrics.sampleRate, crossovers(), config_);
+  }
+
   virtual bool onMetricsUpdate(jack::ProcessingMetrics metrics) override {
     std::cout << "Updated metrics: {rate:" << metrics.sampleRate
               << ", bsize:" << metrics.bufferSize << "}" << std::endl;
+    std::unique_lock<std::mutex> lock(mutex_);
     processor.setSampleRate(metrics.sampleRate, crossovers(), config_);
-    Levels levels(GROUPS);
-    levels.reset();
-    preparedConfigData.configData = processor.getConfigData();
-    preparedConfigData.configChanged =
-        true; // force to reload equalizer filters
-    transport.init(preparedConfigData, true);
-    preparedConfigData.configChanged = false;
+    preparedData_ = processor.getConfigData();
+    // force to reload equalizer filters
+    unappliedParts_ = RuntimeDataParts::ALL;
+    unappliedSequence_ = transport.put({unappliedParts_, preparedData_});
     return true;
   }
 
@@ -175,20 +195,13 @@ protected:
   }
 
   virtual bool process(jack_nframes_t frames, const jack::Ports &ports) override {
-    auto lockFreeData =
-        transport
-            .getLockFreeNoFence(); // method already called from within a fence
-    bool modifiedTransport = lockFreeData.modified();
     ZFPUState state;
 
-    if (modifiedTransport) {
-      processor.levels.reset();
-      if (lockFreeData.data().configChanged) {
-        processor.updateConfig(lockFreeData.data().configData);
-      } else {
-        processor.updateConfig(processor.getConfigData());
-      }
+    if (const ConfigUpdate *update = transport.takeCommand()) {
+      processor.updateConfig(update->data, update->parts);
+      transport.applied();
     }
+    processor.startPeriod(period++);
     size_t portNumber = 0;
     int subPort = config_.subOutput - 1;
     if (subPort >= 0) {
@@ -234,7 +247,7 @@ protected:
       }
     }
 
-    lockFreeData.data().levels = processor.levels;
+    levelRing.push(processor.periodLevels);
 
     return true;
   }
@@ -271,43 +284,51 @@ public:
 
   virtual const SpeakermanConfig &getConfig() const override { return config_; }
 
-  virtual bool getLevels(DynamicProcessorLevels *levels,
-                         std::chrono::milliseconds duration) override {
+  void reserveBufferMemory() override {
     std::unique_lock<std::mutex> lock(mutex_);
-    TransportData result;
-    preparedConfigData.levels.reset();
-    preparedConfigData.configChanged = false;
-    if (transport.getAndSet(preparedConfigData, result, duration)) {
-      if (levels) {
-        *levels = result.levels;
-      }
-      return true;
-    }
-    return false;
+    processor.reserveBufferMemory();
   }
 
-  bool
-  applyConfigAndGetLevels(const SpeakermanConfig &config,
-                          DynamicProcessorLevels *levels,
-                          std::chrono::milliseconds duration) override {
+  void prepareBuffers(double sampleRate) override {
     std::unique_lock<std::mutex> lock(mutex_);
-    TransportData result;
+    processor.prepareSampleRate(sampleRate, crossovers(), config_);
+  }
+
+  size_t getPeriodLevels(PeriodLevels *target, size_t count) override {
+    return levelRing.pop(target, count);
+  }
+
+  bool applyConfig(const SpeakermanConfig &config,
+                   std::chrono::milliseconds duration) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (transport.isApplied(unappliedSequence_)) {
+      unappliedParts_ = 0;
+    }
+    unsigned parts = processor.reconfigureData(preparedData_, config_, config);
     config_ = config;
-    preparedConfigData.configData = processor.createConfigData(config);
-    preparedConfigData.levels.reset();
-    preparedConfigData.configChanged = true;
-    if (transport.getAndSet(preparedConfigData, result, duration)) {
-      if (levels) {
-        *levels = result.levels;
-      }
-      return true;
+    if (parts == 0) {
+      return transport.isApplied(unappliedSequence_);
     }
-    return false;
+    /*
+     * The processing thread only sees the latest published update, so an
+     * update also carries the parts of earlier updates that were not applied
+     * yet. Slots contain older data, so only those parts are copied.
+     */
+    unappliedParts_ |= parts;
+    unappliedSequence_ = transport.fillAndPut([this](ConfigUpdate &update) {
+      update.parts = unappliedParts_;
+      update.data.copyParts(preparedData_, unappliedParts_);
+    });
+    return transport.awaitApplied(unappliedSequence_, duration);
   }
 
   const jack::ProcessingStatistics getStatistics() const override {
     return JackProcessor::getStatistics();
   }
+
+  bool getLimiterFault(LimiterFaultSnapshot &snapshot) override {
+    return processor.fetchLimiterFault(snapshot);
+  }
 };
 
 } // namespace speakerman
@@ -22,6 +22,7 @@
  */
 
 #include <speakerman/DynamicProcessorLevels.h>
+#include <speakerman/LimiterFaultCapture.h>
 #include <speakerman/SpeakermanConfig.hpp>
 
 namespace speakerman {
@@ -30,15 +31,29 @@ class SpeakerManagerControl {
 public:
   virtual const SpeakermanConfig &getConfig() const = 0;
 
-  virtual bool
-  applyConfigAndGetLevels(const SpeakermanConfig &config,
-                          DynamicProcessorLevels *levels,
-                          std::chrono::milliseconds timeoutMillis) = 0;
-
-  virtual bool getLevels(DynamicProcessorLevels *levels,
-                         std::chrono::milliseconds timeoutMillis) = 0;
+  /**
+   * Hands over the configuration to processing, without waiting for it, and
+   * then waits at most the timeout for it to be applied.
+   * @return true if the configuration was applied within the timeout
+   */
+  virtual bool applyConfig(const SpeakermanConfig &config,
+                           std::chrono::milliseconds timeoutMillis) = 0;
+
+  /**
+   * Removes up to count of the oldest period levels and copies them to
+   * target. Meant to be called from a single background thread.
+   * @return the number of period levels copied
+   */
+  virtual size_t getPeriodLevels(PeriodLevels *target, size_t count) = 0;
 
   virtual const jack::ProcessingStatistics getStatistics() const = 0;
+
+  /**
+   * Fetches the oldest captured limiter fault that was not fetched before.
+   * Meant to be called from a single background thread.
+   */
+  virtual bool getLimiterFault(LimiterFaultSnapshot &snapshot) = 0;
+
   virtual ~SpeakerManagerControl() = default;
 };
 
@@ -60,11 +60,16 @@ struct SpeakermanConfig {
 
   static constexpr int DEFAULT_GENERATE_NOISE = 0;
 
+  static constexpr size_t MIN_LEVEL_STREAM_MILLIS = 50;
+  static constexpr size_t DEFAULT_LEVEL_STREAM_MILLIS = 50;
+  static constexpr size_t MAX_LEVEL_STREAM_MILLIS = 1000;
+
   size_t subOutput = DEFAULT_SUB_OUTPUT;
   size_t crossovers = DEFAULT_CROSSOVERS;
   double relativeSubThreshold = DEFAULT_REL_SUB_THRESHOLD;
   double subDelay = DEFAULT_SUB_DELAY;
   int generateNoise = DEFAULT_GENERATE_NOISE;
+  size_t levelStreamMillis = DEFAULT_LEVEL_STREAM_MILLIS;
   DetectionConfig detection;
   LogicalInputsConfig logicalInputs;
   LogicalOutputsConfig logicalOutputs;
@@ -97,9 +102,9 @@ const char *getWebSiteDirectory();
 
 const char *configFileName();
 
-const char *webDirectory();
+const char *levelHistoryFileName();
 
-const char *getWatchDogScript();
+const char *webDirectory();
 
 SpeakermanConfig readSpeakermanConfig();
 
@@ -48,6 +48,55 @@ struct SpeakerManLevels {
   }
 };
 
+/**
+ * Parts of the runtime data that are reconfigured and applied separately,
+ * so that a change only recomputes and hands over what it affects.
+ */
+struct RuntimeDataParts {
+  // Thresholds, delays and flags of the sub and groups and the noise level
+  static constexpr unsigned LEVELS = 1;
+  static constexpr unsigned INPUT_MATRIX = 2;
+  static constexpr unsigned SUB_FILTER = 4;
+  static constexpr unsigned ALL = ~0u;
+
+  static constexpr unsigned groupFilter(size_t group) {
+    return 8u << group;
+  }
+
+  static bool sameEqualizers(size_t eqs1, const EqualizerConfig *eq1,
+                             size_t eqs2, const EqualizerConfig *eq2) {
+    if (eqs1 != eqs2) {
+      return false;
+    }
+    for (size_t i = 0; i < eqs1; i++) {
+      if (eq1[i].center != eq2[i].center || eq1[i].gain != eq2[i].gain ||
+          eq1[i].bandwidth != eq2[i].bandwidth) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool sameLevels(const SpeakermanConfig &c1,
+                         const SpeakermanConfig &c2) {
+    if (c1.threshold_scaling != c2.threshold_scaling ||
+        c1.relativeSubThreshold != c2.relativeSubThreshold ||
+        c1.subDelay != c2.subDelay || c1.generateNoise != c2.generateNoise ||
+        c1.processingGroups.channels != c2.processingGroups.channels) {
+      return false;
+    }
+    for (size_t group = 0; group < c1.processingGroups.groups; group++) {
+      const ProcessingGroupConfig &g1 = c1.processingGroups.group[group];
+      const ProcessingGroupConfig &g2 = c2.processingGroups.group[group];
+      if (g1.threshold != g2.threshold || g1.delay != g2.delay ||
+          g1.useSub != g2.useSub || g1.mono != g2.mono) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 template <typename T> class EqualizerFilterData {
   using Coefficients = FixedSizeIirCoefficients<T, 2>;
   Coefficients biquad1_;
@@ -166,6 +215,15 @@ public:
     delay_ = delay > delay_ ? 0 : delay_ - delay;
   }
 
+  /**
+   * Copies everything except the filter configuration.
+   */
+  void copyLevels(const GroupRuntimeData<T, BANDS> &source) {
+    EqualizerFilterData<T> filterConfig = filterConfig_;
+    *this = source;
+    filterConfig_ = filterConfig;
+  }
+
   void init(const GroupRuntimeData<T, BANDS> &source) {
     *this = source;
   }
@@ -194,9 +252,18 @@ public:
   using InputMatrix =
       tdap::FixedVolumeMatrix<T, LOGICAL_INPUTS, PROCESSING_INPUTS, 32>;
 
-private:
+  /**
+   * Runtime values approach their target once every this many samples.
+   */
   static constexpr size_t CONTROL_INTERVAL = 16;
+
+private:
   static constexpr double CONTROL_CHANGE_SECONDS = 0.1;
+  /**
+   * Relative error at which a value is considered to have reached its target
+   * after passing through both smoothing stages.
+   */
+  static constexpr double SETTLED_ERROR = 1e-6;
   static constexpr double CONTROL_RATE_FACTOR =
       CONTROL_CHANGE_SECONDS / CONTROL_INTERVAL;
   FixedSizeArray<GroupRuntimeData<T, BANDS>, GROUPS> groupConfig_;
@@ -208,7 +275,7 @@ private:
   size_t subDelay_;
   T noiseScale_;
   IntegrationCoefficients<T> controlSpeed_;
-  size_t controlCount_ = 0;
+  size_t settleSteps_ = 0;
   EqualizerFilterData<T> filterConfig_;
 
   void compensateDelays() {
@@ -267,8 +334,7 @@ public:
       groupConfig_[group].reset();
     }
     inputMatrix_.zero();
-    controlCount_ = 0;
-    controlSpeed_.setCharacteristicSamples(5000);
+    setControlSpeed(5000);
     filterConfig_.reset();
   }
 
@@ -279,27 +345,123 @@ public:
     }
   }
 
-  void approach(const SpeakermanRuntimeData &target) {
-    if (controlCount_ == 0) {
-      controlSpeed_.integrate(target.subLimiterThreshold_,
-                              subLimiterThreshold_);
-      controlSpeed_.integrate(target.subLimiterScale_, subLimiterScale_);
-      controlSpeed_.integrate(target.subRmsThreshold_, subRmsThreshold_);
-      controlSpeed_.integrate(target.subRmsScale_, subRmsScale_);
+  /**
+   * Returns the number of approach steps after which a change has settled,
+   * when it passes through two smoothing stages with this control speed.
+   */
+  size_t settleSteps() const { return settleSteps_; }
 
-      for (size_t group = 0; group < GROUPS; group++) {
-        groupConfig_[group].approach(target.groupConfig_[group], controlSpeed_);
-      }
-      inputMatrix_.approach(target.inputMatrix_, controlSpeed_);
+  void approachLevels(const SpeakermanRuntimeData &target) {
+    controlSpeed_.integrate(target.subLimiterThreshold_, subLimiterThreshold_);
+    controlSpeed_.integrate(target.subLimiterScale_, subLimiterScale_);
+    controlSpeed_.integrate(target.subRmsThreshold_, subRmsThreshold_);
+    controlSpeed_.integrate(target.subRmsScale_, subRmsScale_);
+
+    for (size_t group = 0; group < GROUPS; group++) {
+      groupConfig_[group].approach(target.groupConfig_[group], controlSpeed_);
     }
-    controlCount_++;
-    controlCount_ %= CONTROL_INTERVAL;
+  }
+
+  void approachInputs(const SpeakermanRuntimeData &target) {
+    inputMatrix_.approach(target.inputMatrix_, controlSpeed_);
   }
 
   template <typename... A>
   void configure(const SpeakermanConfig &config, double sampleRate,
                  const ArrayTraits<A...> &bandWeights,
                  double fastestPeakWeight) {
+    validate(config);
+    for (size_t group = 0; group < GROUPS; group++) {
+      configureGroupFilter(config, group, sampleRate);
+    }
+    configureLevels(config, sampleRate, bandWeights, fastestPeakWeight);
+    for (size_t logicalChannel = 0; logicalChannel < LOGICAL_INPUTS;
+         logicalChannel++) {
+      configureInputs(config, logicalChannel);
+    }
+    setFilterConfig(
+        EqualizerFilterData<T>::createConfigured(config, sampleRate));
+  }
+
+  /**
+   * Reconfigures only the parts that are affected by the differences between
+   * the previous configuration, that this data was configured with, and the
+   * new one. Within the input matrix, only the weights of logical inputs that
+   * changed are recalculated.
+   * @return the parts that were reconfigured, as RuntimeDataParts
+   */
+  template <typename... A>
+  unsigned reconfigure(const SpeakermanConfig &previous,
+                       const SpeakermanConfig &config, double sampleRate,
+                       const ArrayTraits<A...> &bandWeights,
+                       double fastestPeakWeight) {
+    validate(config);
+    unsigned parts = 0;
+    for (size_t group = 0; group < GROUPS; group++) {
+      const ProcessingGroupConfig &was = previous.processingGroups.group[group];
+      const ProcessingGroupConfig &is = config.processingGroups.group[group];
+      if (!RuntimeDataParts::sameEqualizers(was.eqs, was.eq, is.eqs, is.eq)) {
+        configureGroupFilter(config, group, sampleRate);
+        parts |= RuntimeDataParts::groupFilter(group);
+      }
+    }
+    if (!RuntimeDataParts::sameLevels(previous, config)) {
+      configureLevels(config, sampleRate, bandWeights, fastestPeakWeight);
+      parts |= RuntimeDataParts::LEVELS;
+    }
+    for (size_t logicalChannel = 0; logicalChannel < LOGICAL_INPUTS;
+         logicalChannel++) {
+      if (!sameInputs(previous, config, logicalChannel)) {
+        configureInputs(config, logicalChannel);
+        parts |= RuntimeDataParts::INPUT_MATRIX;
+      }
+    }
+    if (!RuntimeDataParts::sameEqualizers(previous.eqs, previous.eq,
+                                          config.eqs, config.eq)) {
+      setFilterConfig(
+          EqualizerFilterData<T>::createConfigured(config, sampleRate));
+      parts |= RuntimeDataParts::SUB_FILTER;
+    }
+    return parts;
+  }
+
+  /**
+   * Copies the given parts from the source, leaving the rest as is.
+   */
+  void copyParts(const SpeakermanRuntimeData &source, unsigned parts) {
+    if (parts == RuntimeDataParts::ALL) {
+      *this = source;
+      return;
+    }
+    if (parts & RuntimeDataParts::LEVELS) {
+      for (size_t group = 0; group < GROUPS; group++) {
+        groupConfig_[group].copyLevels(source.groupConfig_[group]);
+      }
+      subLimiterScale_ = source.subLimiterScale_;
+      subLimiterThreshold_ = source.subLimiterThreshold_;
+      subRmsThreshold_ = source.subRmsThreshold_;
+      subRmsScale_ = source.subRmsScale_;
+      subDelay_ = source.subDelay_;
+      noiseScale_ = source.noiseScale_;
+      controlSpeed_ = source.controlSpeed_;
+      settleSteps_ = source.settleSteps_;
+    }
+    if (parts & RuntimeDataParts::INPUT_MATRIX) {
+      inputMatrix_ = source.inputMatrix_;
+    }
+    for (size_t group = 0; group < GROUPS; group++) {
+      if (parts & RuntimeDataParts::groupFilter(group)) {
+        groupConfig_[group].setFilterConfig(
+            source.groupConfig_[group].filterConfig());
+      }
+    }
+    if (parts & RuntimeDataParts::SUB_FILTER) {
+      filterConfig_ = source.filterConfig_;
+    }
+  }
+
+private:
+  static void validate(const SpeakermanConfig &config) {
     if (config.processingGroups.groups != GROUPS) {
       std::cerr << "GROUPS=" << GROUPS << " != "
                 << "config.processingGroups.groups=" << config.processingGroups.groups
@@ -318,46 +480,82 @@ public:
       throw std::invalid_argument(
           "Cannot change number of logical input-channels at runtime.");
     }
+  }
+
+  void setControlSpeed(double characteristicSamples) {
+    controlSpeed_.setCharacteristicSamples(characteristicSamples);
+    // Step response of both smoothing stages, done once here so that
+    // approaching needs no comparisons to know when it is done.
+    T middle = 0;
+    T active = 0;
+    settleSteps_ = 0;
+    while (1.0 - active > SETTLED_ERROR &&
+           settleSteps_ < 100 * characteristicSamples) {
+      controlSpeed_.integrate(T(1), middle);
+      controlSpeed_.integrate(middle, active);
+      settleSteps_++;
+    }
+  }
+
+  void configureGroupFilter(const SpeakermanConfig &config, size_t group,
+                            double sampleRate) {
+    groupConfig_[group].setFilterConfig(EqualizerFilterData<T>::createConfigured(
+        config.processingGroups.group[group], sampleRate));
+  }
+
+  static bool sameInputs(const SpeakermanConfig &previous,
+                         const SpeakermanConfig &config,
+                         size_t logicalChannel) {
+    if (previous.logicalInputs.volumeForChannel(logicalChannel) !=
+        config.logicalInputs.volumeForChannel(logicalChannel)) {
+      return false;
+    }
+    for (size_t processingChannel = 0; processingChannel < PROCESSING_INPUTS;
+         processingChannel++) {
+      if (previous.inputMatrix.weight(processingChannel, logicalChannel) !=
+          config.inputMatrix.weight(processingChannel, logicalChannel)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void configureInputs(const SpeakermanConfig &config, size_t logicalChannel) {
+    double volume = config.logicalInputs.volumeForChannel(logicalChannel);
+    for (size_t processingChannel = 0; processingChannel < PROCESSING_INPUTS;
+         processingChannel++) {
+      double weight =
+          config.inputMatrix.weight(processingChannel, logicalChannel);
+      inputMatrix_.set(processingChannel, logicalChannel, weight * volume);
+    }
+  }
+
+  template <typename... A>
+  void configureLevels(const SpeakermanConfig &config, double sampleRate,
+                       const ArrayTraits<A...> &bandWeights,
+                       double fastestPeakWeight) {
     double subBaseThreshold = ProcessingGroupConfig::MAX_THRESHOLD;
     double peakWeight = Values::force_between(fastestPeakWeight, 0.1, 1.0);
-    double max_group_threshold = 0;
 
     for (size_t group = 0; group < config.processingGroups.groups; group++) {
-      speakerman::ProcessingGroupConfig sourceConf =
+      const ProcessingGroupConfig &sourceConf =
           config.processingGroups.group[group];
 
-      GroupRuntimeData<T, BANDS> &targetConf = groupConfig_[group];
-      targetConf.setFilterConfig(
-          EqualizerFilterData<T>::createConfigured(sourceConf, sampleRate));
-
       double groupThreshold =
           Value<double>::min(sourceConf.threshold * config.threshold_scaling,
                              ProcessingGroupConfig::MAX_THRESHOLD);
-      max_group_threshold =
-          Value<double>::max(max_group_threshold, groupThreshold);
 
       size_t delay = 0.5 + sampleRate * Values::force_between(
                                             sourceConf.delay,
                                             ProcessingGroupConfig::MIN_DELAY,
                                             ProcessingGroupConfig::MAX_DELAY);
-      targetConf.setLevels(sourceConf, config.threshold_scaling,
-                           config.processingGroups.channels, fastestPeakWeight,
-                           delay, bandWeights);
+      groupConfig_[group].setLevels(sourceConf, config.threshold_scaling,
+                                    config.processingGroups.channels,
+                                    fastestPeakWeight, delay, bandWeights);
 
       subBaseThreshold = Values::min(subBaseThreshold, groupThreshold);
     }
 
-    for (size_t logicalChannel = 0; logicalChannel < LOGICAL_INPUTS;
-         logicalChannel++) {
-      double volume = config.logicalInputs.volumeForChannel(logicalChannel);
-      for (size_t processingChannel = 0; processingChannel < PROCESSING_INPUTS;
-           processingChannel++) {
-        double weight =
-            config.inputMatrix.weight(processingChannel, logicalChannel);
-        inputMatrix_.set(processingChannel, logicalChannel, weight * volume);
-      }
-    }
-
     if (config.generateNoise) {
       noiseScale_ = 20.0;
     } else {
@@ -379,14 +577,12 @@ public:
         0.5 + sampleRate * Values::force_between(
                                config.subDelay, SpeakermanConfig::MIN_SUB_DELAY,
                                SpeakermanConfig::MAX_SUB_DELAY);
-    controlSpeed_.setCharacteristicSamples(CONTROL_RATE_FACTOR * sampleRate);
-    controlCount_ = 0;
-    setFilterConfig(
-        EqualizerFilterData<T>::createConfigured(config, sampleRate));
+    setControlSpeed(CONTROL_RATE_FACTOR * sampleRate);
 
     compensateDelays();
   }
 
+public:
   void dump() const {
     std::cout << "Runtime Configuration dump" << std::endl;
     std::cout << " sub-limiter: scale=" << subLimiterScale()
@@ -505,6 +701,15 @@ class SpeakermanRuntimeConfigurable {
   Data active_;
   Data middle_;
   Data userSet_;
+  size_t controlCount_ = 0;
+  // Approach steps left before levels or inputs settle, zero if settled
+  size_t levelSteps_ = 0;
+  size_t inputSteps_ = 0;
+
+  void settle(unsigned parts) {
+    middle_.copyParts(userSet_, parts);
+    active_.copyParts(userSet_, parts);
+  }
 
 public:
   const Data &data() const { return active_; }
@@ -521,11 +726,19 @@ public:
     userSet_.reset();
   }
 
-  void modify(const Data &source) {
-    userSet_ = source;
+  void modify(const Data &source, unsigned parts = RuntimeDataParts::ALL) {
+    userSet_.copyParts(source, parts);
+    if (parts & RuntimeDataParts::LEVELS) {
+      levelSteps_ = 1 + userSet_.settleSteps();
+    }
+    if (parts & RuntimeDataParts::INPUT_MATRIX) {
+      inputSteps_ = 1 + userSet_.settleSteps();
+    }
     for (size_t group = 0; group < GROUPS; group++) {
-      active_.groupConfig(group).setFilterConfig(
-          source.groupConfig(group).filterConfig());
+      if (parts & RuntimeDataParts::groupFilter(group)) {
+        active_.groupConfig(group).setFilterConfig(
+            source.groupConfig(group).filterConfig());
+      }
     }
   }
 
@@ -533,11 +746,39 @@ public:
     userSet_ = source;
     middle_.init(userSet_);
     active_.init(middle_);
+    levelSteps_ = 0;
+    inputSteps_ = 0;
   }
 
+  /**
+   * Lets the active runtime data approach the user set data, once every
+   * control interval, through two smoothing stages. Levels and inputs are
+   * only approached during a fixed number of steps after they were modified,
+   * after which they are set to their exact target and left alone.
+   */
   void approach() {
-    middle_.approach(userSet_);
-    active_.approach(middle_);
+    if ((levelSteps_ | inputSteps_) == 0) {
+      return;
+    }
+    if (controlCount_ > 0) {
+      controlCount_--;
+      return;
+    }
+    controlCount_ = Data::CONTROL_INTERVAL - 1;
+    if (levelSteps_ > 0) {
+      middle_.approachLevels(userSet_);
+      active_.approachLevels(middle_);
+      if (--levelSteps_ == 0) {
+        settle(RuntimeDataParts::LEVELS);
+      }
+    }
+    if (inputSteps_ > 0) {
+      middle_.approachInputs(userSet_);
+      active_.approachInputs(middle_);
+      if (--inputSteps_ == 0) {
+        settle(RuntimeDataParts::INPUT_MATRIX);
+      }
+    }
   }
 };
 
@@ -21,11 +21,16 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <org-simple/util/text/Json.h>
 #include <speakerman/DynamicProcessorLevels.h>
+#include <speakerman/LevelHistory.h>
+#include <speakerman/LevelRecord.h>
 #include <speakerman/SpeakerManagerControl.h>
+#include <speakerman/ThresholdScalingMonitor.h>
 #include <speakerman/Webserver.h>
 #include <tdap/Count.hpp>
 #include <tdap/Power2.hpp>
@@ -39,57 +44,86 @@ static long long current_millis() {
   return system_clock::now().time_since_epoch().count() / 1000000;
 }
 
-struct LevelEntry {
-  DynamicProcessorLevels levels;
-  bool set;
+/**
+ * Levels of one update, serialized as JSON by the level fetching thread. A
+ * payload is immutable once published, so handlers can send it to any number
+ * of clients without copying or locking.
+ */
+struct LevelPayload {
+  uint64_t sequence;
   long long stamp;
+  // Stamp of the previous update, where the levels of this one start
+  long long previousStamp;
+  DynamicProcessorLevels levels;
+  std::string json;
+  std::string etag;
+};
 
-  LevelEntry() : set(false) {}
+/**
+ * Keeps the most recent level payloads, so that a client that did not see
+ * some updates gets the levels of all of those merged.
+ */
+class LevelPayloadBuffer {
+  mutex m;
+  static constexpr size_t SIZE = 64;
+  std::shared_ptr<const LevelPayload> entries[SIZE];
+  uint64_t latest_ = 0;
 
-  LevelEntry(DynamicProcessorLevels lvl)
-      : levels(lvl), set(true), stamp(current_millis()) {}
+public:
+  void put(const std::shared_ptr<const LevelPayload> &payload);
+
+  /**
+   * Replaces levels with the merged levels of the kept payloads after the
+   * given sequence and sets since to the stamp where those levels start.
+   * @return the latest payload, or nullptr if no payloads after the
+   * sequence are kept.
+   */
+  std::shared_ptr<const LevelPayload>
+  mergeSince(uint64_t sequence, DynamicProcessorLevels &levels,
+             long long &since);
+};
+
+struct LimiterFaultEntry {
+  long long stamp = 0;
+  size_t limiter = 0;
+  std::string csv;
 };
 
-class LevelEntryBuffer {
+/**
+ * Keeps the most recent limiter faults as CSV, for download.
+ */
+class LimiterFaultBuffer {
   mutex m;
-  static constexpr size_t SIZE = 128;
-  static constexpr size_t MASK = SIZE - 1;
-  LevelEntry entries[SIZE];
-  size_t wr_;
+  static constexpr size_t SIZE = 8;
+  LimiterFaultEntry entries[SIZE];
+  size_t count_ = 0;
 
-  static size_t prev(size_t n) { return (n + SIZE - 1) & MASK; }
+public:
+  void put(const LimiterFaultSnapshot &snapshot);
 
-  static size_t next(size_t n) { return (n + 1) & MASK; }
+  size_t count();
 
-public:
-  void put(const DynamicProcessorLevels &levels) {
-    unique_lock<mutex> lock(m);
-    wr_ = prev(wr_);
-    entries[wr_] = LevelEntry(levels);
-  }
-
-  void get(long long lastChecked, LevelEntry &target) {
-    unique_lock<mutex> lock(m);
-    target = entries[wr_];
-    if (lastChecked <= 0) {
-      return;
-    }
-    size_t read = wr_;
-    read = next(read);
-    LevelEntry entry = entries[read];
-    while (read != wr_ && entry.set && entry.stamp > lastChecked) {
-      target.levels += entry.levels;
-      read = next(read);
-      entry = entries[read];
-    }
-  }
+  /**
+   * Gets a recent fault, where index zero is the most recent one.
+   */
+  bool get(size_t index, LimiterFaultEntry &target);
 };
 
 class web_server : public WebServer {
 public:
-  static constexpr const char *COOKIE_TIME_STAMP = "levelTimeStamp";
-  static constexpr size_t COOKIE_TIME_STAMP_LENGTH =
-      tdap::constexpr_string_length(COOKIE_TIME_STAMP);
+  /**
+   * Label of connections that subscribed to the level stream.
+   */
+  static constexpr const char *LEVEL_STREAM_LABEL = "levels/stream";
+  /**
+   * Level frames are not sent to a subscriber that has more than this amount
+   * of bytes waiting to be sent, so that slow clients skip frames.
+   */
+  static constexpr size_t LEVEL_STREAM_BACKLOG = 16384;
+  /**
+   * Poll interval that is short enough to stream levels on time.
+   */
+  static constexpr long POLL_MILLIS = 10;
 
   web_server(SpeakerManagerControl &speakerManager);
 
@@ -99,7 +133,14 @@ protected:
   HttpResultHandleResult handle(mg_connection *connection,
                                 mg_http_message *httpMessage) override;
 
+  void onPoll(mg_mgr *manager) override;
+
 private:
+  /**
+   * Builds a reply. Requests are handled one at a time on the web server
+   * thread, so one response is reused for all of them and its buffers only
+   * grow until they fit the largest reply.
+   */
   class Response {
     static constexpr size_t LENGTH = 30;
     static constexpr const char *const NEWLINE = "\r\n";
@@ -130,7 +171,6 @@ private:
       headers += name;
       headers += ": ";
       write_number(headers, value);
-      headers += value;
       if (extra) {
         headers += "; ";
         headers += extra;
@@ -150,6 +190,21 @@ private:
       headers += NEWLINE;
     }
 
+    static const char *statusText(int code) {
+      switch (code) {
+      case 200:
+        return "OK";
+      case 400:
+        return "Bad Request";
+      case 404:
+        return "Not Found";
+      case 503:
+        return "Service Unavailable";
+      default:
+        return code < 400 ? "OK" : "Internal Server Error";
+      }
+    }
+
   public:
     void clear() {
       body.clear();
@@ -179,14 +234,31 @@ private:
       }
     };
 
+    /**
+     * Sends status, headers and body to the connection's send buffer. Unlike
+     * mg_http_reply(), this does not format the body as a printf format or
+     * allocate a temporary copy of it.
+     */
     void createReply(mg_connection *connection, int code = 200) {
-      if (contentType.length() > 0) {
-        headers += contentType;
-      }
-      snprintf(numberPad, 24, "%zu", body.length());
-      addHeader("Content-Length", numberPad);
+      createReply(connection, code, body);
+    }
 
-      mg_http_reply(connection, code, headers.c_str(), body.c_str());
+    /**
+     * Like createReply(), with a body that was serialized elsewhere.
+     */
+    void createReply(mg_connection *connection, int code,
+                     const std::string &content) {
+      response = "HTTP/1.1 ";
+      write_number(response, code);
+      response += ' ';
+      response += statusText(code);
+      response += NEWLINE;
+      response += headers;
+      response += contentType;
+      addHeader(response, "Content-Length", content.length(), nullptr);
+      response += NEWLINE;
+      mg_send(connection, response.data(), response.length());
+      mg_send(connection, content.data(), content.length());
     }
 
     void write_string(const char *str) { body += str; }
@@ -208,6 +280,8 @@ private:
 
     void write(char c) { body += c; }
 
+    const std::string &getBody() const { return body; }
+
     template <typename V>
     void addCookie(const char *const name, V value,
                    const char *extra) {
@@ -320,24 +394,48 @@ private:
     }
   };
 
-  void handleTimeStampCookie(const char *header, const char *value);
   static void thread_static_function(web_server *);
   void thread_function();
   void handleConfigurationChanges(mg_connection *connection,
                                   const char *configurationJson);
   void writeInputVolumes(Json &json);
-  bool applyConfigAndGetLevels(DynamicProcessorLevels &levels,
-                               milliseconds &wait);
+  void writeLevels(Json &json, const DynamicProcessorLevels &levels);
+  void writeLevelUpdate(Response &target, uint64_t sequence,
+                        long long elapsedMillis,
+                        const DynamicProcessorLevels &levels);
+  std::shared_ptr<const LevelPayload>
+  levelsSince(uint64_t sequence, Response &target, const std::string *&json);
+  static uint64_t levelSequence(const mg_str *etag);
+  void publishLevels(const DynamicProcessorLevels &levels);
+  bool writeLevelHistory(Json &json, mg_http_message *httpMessage);
+  static bool isLevelSubscriber(const mg_connection *connection);
+  void fetchLimiterFaults();
+  void drainLevels();
+  bool applyConfig(milliseconds &wait);
 
   SpeakerManagerControl &manager_;
-  LevelEntryBuffer level_buffer;
+  std::atomic<std::shared_ptr<const LevelPayload>> levelPayload;
+  LevelPayloadBuffer levelPayloads;
+  LevelRecordRing levelRecords;
+  LevelHistory levelHistory;
+  // Only used by the level fetching thread
+  Response levelFrame;
+  LevelRecord levelRecord;
+  LimiterFaultBuffer fault_buffer;
+  LimiterFaultSnapshot faultSnapshot;
+  ThresholdScalingMonitor thresholdScaling;
   std::thread level_fetch_thread;
-  long long levelTimeStamp = 0;
   SpeakermanConfig configFileConfig;
   SpeakermanConfig clientFileConfig;
   SpeakermanConfig usedFileConfig;
-  std::mutex handlingMutex;
   Response response;
+  // Only used by the web server thread
+  Response streamFrame;
+  DynamicProcessorLevels mergedLevels;
+  uint64_t streamSequence = 0;
+  std::string levelRecordReply;
+  std::vector<LevelHistoryBucket> historyBuckets;
+  long long nextStreamMillis = 0;
 };
 
 } // namespace speakerman
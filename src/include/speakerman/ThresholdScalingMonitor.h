@@ -0,0 +1,95 @@
+#ifndef SPEAKERMAN_M_THRESHOLD_SCALING_MONITOR_H
+#define SPEAKERMAN_M_THRESHOLD_SCALING_MONITOR_H
+/*
+ * speakerman/ThresholdScalingMonitor.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace speakerman {
+
+/**
+ * Periodically fetches time ranges with a threshold scaling from a URL and
+ * publishes the scaling of the range that is active now, or 1 if none is.
+ *
+ * Ranges are lines like "202610182000-202610190100: 3" or
+ * "2026-10-18 20:00 - 2026-10-19 01:00 : 3", where times are local and
+ * anything after a '#' is a comment. The URL is the threshold-scale-url in
+ * the configuration file, or a default. This runs on its own thread and only
+ * spawns curl for the download, so it does not stall level fetching.
+ */
+class ThresholdScalingMonitor {
+public:
+  static constexpr int CHECK_SECONDS = 5;
+  static constexpr int DOWNLOAD_SECONDS = 20;
+  static constexpr int DEFAULT_SCALING = 1;
+  static constexpr size_t MAX_DOWNLOAD_BYTES = 1048576;
+  static constexpr const char *DEFAULT_URL =
+      "https://script.google.com/macros/s/"
+      "AKfycbwK3NWPuTKciZoE19xpX5AiZWiPEV8wZSGmKxlULO1FjDg-BFFv/exec";
+
+  /**
+   * Starts monitoring.
+   * @param configFile The configuration file that can contain the URL
+   * @param maximum The maximum valid scaling
+   */
+  ThresholdScalingMonitor(const char *configFile, int maximum);
+
+  ThresholdScalingMonitor(const ThresholdScalingMonitor &) = delete;
+
+  ~ThresholdScalingMonitor();
+
+  /**
+   * Returns the most recently determined threshold scaling.
+   */
+  int scaling() const { return scaling_; }
+
+  /**
+   * Returns the scaling of the first range in the text that contains now,
+   * or DEFAULT_SCALING if there is none.
+   * @param text Ranges, one per line
+   * @param now Local time as a number, formatted as YYYYMMDDhhmm.
+   * @param maximum The maximum valid scaling
+   */
+  static int scalingForRanges(const char *text, long long now, int maximum);
+
+  /**
+   * Returns the local time as a number, formatted as YYYYMMDDhhmm.
+   */
+  static long long localStamp();
+
+private:
+  const std::string configFile_;
+  const int maximum_;
+  std::atomic_int scaling_ = DEFAULT_SCALING;
+  std::atomic_bool stop_ = false;
+  std::thread thread_;
+
+  void run();
+  void sleep(int seconds) const;
+  std::string readUrl() const;
+  bool download(const std::string &url, std::string &output) const;
+};
+
+} // namespace speakerman
+
+#endif // SPEAKERMAN_M_THRESHOLD_SCALING_MONITOR_H
@@ -25,6 +25,7 @@
 #include <condition_variable>
 #include <mongoose.h>
 #include <mutex>
+#include <speakerman/SingleThreadFileCache.hpp>
 
 namespace speakerman {
 
@@ -45,10 +46,26 @@ public:
 
   void defaultHandle(mg_connection *connection, mg_http_message *httpMessage);
 
+private:
+  // Page assets, served from memory by the web server thread
+  file_entry indexHtml;
+  file_entry script;
+  file_entry styleSheet;
+
+  file_entry *cachedAsset(const mg_str &uri);
+
+  bool serveCached(mg_connection *connection, mg_http_message *httpMessage);
+
 protected:
   virtual HttpResultHandleResult handle(mg_connection *connection,
                                         mg_http_message *httpMessage);
 
+  /**
+   * Called after each poll of the connections, for instance to push data to
+   * connections that were upgraded to WebSockets.
+   */
+  virtual void onPoll(mg_mgr *) {}
+
 public:
   WebServer(const char *documentRoot);
 
@@ -259,6 +259,11 @@ public:
 
   ClientState getState();
 
+  /**
+   * Returns the sample rate of the server, that processing will start with.
+   */
+  jack_nframes_t getSampleRate();
+
   void notifyShutdown(const char *reason);
 
   ShutDownInfo awaitClose();
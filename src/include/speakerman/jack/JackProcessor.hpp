@@ -144,6 +144,15 @@ protected:
    */
   virtual bool onMetricsUpdate(ProcessingMetrics metrics) = 0;
 
+  /**
+   * Prepare whatever takes time for the (new) processing metrics, so that
+   * onMetricsUpdate() can be short.
+   * Called before processing is suspended for onMetricsUpdate(), so it must
+   * not change anything that is used by process().
+   * @param metrics The (new) processing metrics
+   */
+  virtual void onPrepareMetrics(ProcessingMetrics) {}
+
   /**
    * Do whatever is necessary when the ports are registered with
    * the Jack server, for instance, change port connections.
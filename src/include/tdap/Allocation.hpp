@@ -47,13 +47,15 @@ namespace tdap {
          *
          * @param block_size maximum size of consecutive allocation, rounded
          *        up to nearest page
+         * @param prefault whether to fault in the whole block up front, with
+         *        huge pages if possible, or only the pages that are used
          * @return a handle to pass to various
          * @see ConsecutiveAllocationGuard::Enable
          * @see ConsecutiveAllocationGuard::Disable
          * @see ConsecutiveAllocationGuard::CheckedDisable
          * @see #free()
          */
-        static consecutive_block_handle_t* construct_with_size(size_t block_size);
+        static consecutive_block_handle_t* construct_with_size(size_t block_size, bool prefault = true);
 
 
         /**
@@ -171,7 +173,7 @@ namespace tdap {
         }
     public:
         
-        ConsecutiveAllocationOwner(size_t block_size) : handle_(consecutive_alloc::construct_with_size(block_size))
+        ConsecutiveAllocationOwner(size_t block_size, bool prefault = true) : handle_(consecutive_alloc::construct_with_size(block_size, prefault))
         {
             consecutive_alloc::set_owner(handle_, this);
         }
@@ -286,7 +288,7 @@ namespace tdap {
             return *get();
         }
 
-        ConsecutiveAllocatedObjectOwner(size_t block_size) : ConsecutiveAllocationOwner(block_size) {
+        ConsecutiveAllocatedObjectOwner(size_t block_size, bool prefault = true) : ConsecutiveAllocationOwner(block_size, prefault) {
             consecutive_alloc::Enable guard = enable();
             object_ = create_trivial_instance<Object>();
         }
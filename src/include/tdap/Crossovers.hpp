@@ -24,7 +24,6 @@
 
 #include <tdap/FixedSizeArray.hpp>
 #include <tdap/IirButterworth.hpp>
-#include <tdap/Noise.hpp>
 #include <tdap/Value.hpp>
 #include <tdap/Weighting.hpp>
 
@@ -69,6 +68,15 @@ struct Crossovers {
 
   template <typename T, size_t CHANNELS>
   struct CrossoverExecutor<T, CHANNELS, 1> {
+    /**
+     * Returns the power response of the band, given the power responses of
+     * the low- and high-pass of each crossover.
+     */
+    static double bandPower(size_t band, const double *low,
+                            const double *high) {
+      return band == 0 ? low[0] : high[0];
+    }
+
     template <typename S, class A, class B>
     static void filter(const A &input,
                        B &output,
@@ -86,6 +94,18 @@ struct Crossovers {
 
   template <typename T, size_t CHANNELS>
   struct CrossoverExecutor<T, CHANNELS, 2> {
+    static double bandPower(size_t band, const double *low,
+                            const double *high) {
+      switch (band) {
+      case 0:
+        return low[1] * low[0];
+      case 1:
+        return low[1] * high[0];
+      default:
+        return high[1];
+      }
+    }
+
     template <typename S, class A, class B>
     static void filter(const A &input,
                        B &output,
@@ -107,6 +127,20 @@ struct Crossovers {
 
   template <typename T, size_t CHANNELS>
   struct CrossoverExecutor<T, CHANNELS, 3> {
+    static double bandPower(size_t band, const double *low,
+                            const double *high) {
+      switch (band) {
+      case 0:
+        return low[1] * low[0];
+      case 1:
+        return low[1] * high[0];
+      case 2:
+        return high[1] * low[2];
+      default:
+        return high[1] * high[2];
+      }
+    }
+
     template <typename S, class A, class B>
     static void filter(const A &input,
                        B &output,
@@ -158,58 +192,80 @@ struct Crossovers {
     }
   };
 
+  /**
+   * Returns the RMS weight of each band for band-limited pink noise, relative
+   * to the full-range RMS of that noise. Even elements are unweighted and
+   * odd elements are A-weighted, per band.
+   *
+   * Pink noise has the same power per octave, so the power of each band is
+   * the average of the power responses of all filters involved, sampled
+   * evenly on a logarithmic frequency scale. This takes a fraction of a
+   * millisecond, where simulating noise through the filters took seconds.
+   */
   template <typename T, size_t CROSSOVERS, typename... A>
   static const FixedSizeArray<T, 2 * CROSSOVERS + 2>
   weights(const FixedSizeArrayTraits<T, CROSSOVERS, A...> &crossovers,
           double sampleRate) {
+    static constexpr double LOWEST_FREQUENCY = 5.0;
+    static constexpr double STEPS_PER_OCTAVE = 48;
+    using Executor = CrossoverExecutor<T, 1, CROSSOVERS>;
+    static constexpr size_t BANDS = CROSSOVERS + 1;
 
-    size_t samples = 2 * sampleRate;
-    FixedSizeArray<T, 2 * CROSSOVERS + 2> y;
-    PinkNoise::Default noise(1.0, sampleRate / 20);
-    Filter<T, double, 2, CROSSOVERS> crossover;
-    crossover.configure(sampleRate, crossovers);
-    ACurves::Filter<T, 1> curves;
-    curves.setSampleRate(sampleRate);
-    curves.reset();
-
-    // Cut off irrelevant low frequencies
-    FixedSizeIirCoefficientFilter<double, 1, 4> cutoffLow;
-    auto llCoeffs = cutoffLow.coefficients_.wrap();
+    FixedSizeArray<T, CROSSOVERS> frequencies =
+        validatedCrossoverFrequencies<T, CROSSOVERS>(crossovers);
+    FixedSizeArray<LinkwitzRiley<T, 1>, CROSSOVERS> crossover;
+    for (size_t i = 0; i < CROSSOVERS; i++) {
+      crossover[i].configure(sampleRate, frequencies[i]);
+    }
+    ACurves::Coefficients<T> curve(sampleRate);
+
+    // Cut off irrelevant low and high frequencies
+    FixedSizeIirCoefficients<double, 4> cutoffLow;
+    auto llCoeffs = cutoffLow.wrap();
     Butterworth::create(llCoeffs, sampleRate, 20.0, Butterworth::Pass::HIGH,
                         1.0);
-    FixedSizeIirCoefficientFilter<double, 1, 4> cutoffHigh;
-    auto hhCoeffs = cutoffHigh.coefficients_.wrap();
+    FixedSizeIirCoefficients<double, 4> cutoffHigh;
+    auto hhCoeffs = cutoffHigh.wrap();
     Butterworth::create(hhCoeffs, sampleRate, 8000.0, Butterworth::Pass::LOW,
                         1.0);
 
-    // initialization
-    cutoffLow.reset();
-    cutoffHigh.reset();
-    double unweightedTotal = 0.0;
-    for (size_t band = 0; band < y.capacity(); band++) {
-      y[band] = 0.0;
+    double total = 0.0;
+    double unweighted[BANDS];
+    double weighted[BANDS];
+    for (size_t band = 0; band < BANDS; band++) {
+      unweighted[band] = 0.0;
+      weighted[band] = 0.0;
     }
-    FixedSizeArray<double, 2> filtered;
-    for (size_t sample = 0; sample < samples; sample++) {
-      double noiseValue = noise();
-      T input = cutoffHigh.filter(
-          0, cutoffLow.filter(0, noiseValue)); // bandwidth limited pink noise
-      unweightedTotal += input * input; // unweighted full-range measurement
-      filtered[0] = input;              // apply keying filter
-      filtered[1] = curves.filter(0, input); // apply keying filter
-      const auto &w =
-          crossover.filter(filtered);
-      for (size_t band = 0; band < 2 * CROSSOVERS + 2; band++) {
-        const T x = w[band];
-        y[band] += x * x; // weighted-keyed measurement per band
+    const double step = pow(2.0, 1.0 / STEPS_PER_OCTAVE);
+    for (double frequency = LOWEST_FREQUENCY; frequency < 0.5 * sampleRate;
+         frequency *= step) {
+      double relative = frequency / sampleRate;
+      double input = cutoffLow.getPowerResponse(relative) *
+                     cutoffHigh.getPowerResponse(relative);
+      double aWeighted = input * curve.getPowerResponse(relative);
+      double low[CROSSOVERS];
+      double high[CROSSOVERS];
+      for (size_t i = 0; i < CROSSOVERS; i++) {
+        // Linkwitz-Riley: each pass is applied twice
+        double lowPass =
+            crossover[i].lowPass.coefficients_.getPowerResponse(relative);
+        double highPass =
+            crossover[i].highPass.coefficients_.getPowerResponse(relative);
+        low[i] = lowPass * lowPass;
+        high[i] = highPass * highPass;
+      }
+      total += input;
+      for (size_t band = 0; band < BANDS; band++) {
+        double bandPower = Executor::bandPower(band, low, high);
+        unweighted[band] += input * bandPower;
+        weighted[band] += aWeighted * bandPower;
       }
     }
-    for (size_t band = 0; band < 2 * CROSSOVERS + 2; band++) {
-      T sqrtRelativeWeight = sqrt(y[band] / unweightedTotal);
-      y[band] =
-          sqrtRelativeWeight; // correct with unweighted full-range measurement
+    FixedSizeArray<T, 2 * CROSSOVERS + 2> y;
+    for (size_t band = 0; band < BANDS; band++) {
+      y[2 * band] = sqrt(unweighted[band] / total);
+      y[2 * band + 1] = sqrt(weighted[band] / total);
     }
-
     return y;
   };
 };
@@ -22,6 +22,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <tdap/Array.hpp>
 #include <tdap/Power2.hpp>
 
@@ -153,69 +155,53 @@ public:
   }
 };
 
+/**
+ * Delay for multiple channels, where each channel has its own delay.
+ *
+ * Each channel has its own delay line with a power-of-two capacity, so that
+ * positions wrap around with a mask. All channels share the write position.
+ * Next to per-sample access with setAndGet() and next(), a whole block of
+ * frames can be moved through a channel with process() and next(frames),
+ * which needs at most two copies into and two copies out of the line.
+ */
 template <typename S> struct MultiChannelAndTimeDelay {
-  struct Entry {
-    size_t read_, write_, delay_, end_;
+  static_assert(is_trivially_copyable<S>::value,
+                "Expected trivially copyable type parameter");
 
-    inline void init(size_t channels, size_t channel) noexcept {
-      setDelay(channels, channel, 0);
-    }
-
-    inline void reset(size_t channels, size_t channel) noexcept {
-      setDelay(channels, channel, delay_);
-    }
-
-    inline void setDelay(size_t channels, size_t channel, size_t delay) noexcept {
-      read_ = channel;
-      write_ = read_ + delay * channels;
-      end_ = channels * (delay + 1);
-      delay_ = delay;
-    }
-
-    inline void next(size_t channels) noexcept {
-      read_ = (read_ + channels) % end_;
-      write_ = (write_ + channels) % end_;
-    }
-
-    [[nodiscard]] inline size_t delay() const noexcept { return delay_; }
-  };
-
-  size_t maxChannels_, maxDelay_, channels_, delay_;
+  size_t maxChannels_, maxDelay_, capacity_, mask_, channels_;
+  size_t position_;
   Array<S> buffer_;
-  Array<Entry> entry_;
+  Array<size_t> delay_;
 
   static size_t getValidMaxChannels(size_t maxChannels, size_t maxDelay) {
     if (maxDelay == 0 || !Count<S>::is_valid_sum(maxDelay, 1)) {
       throw std::runtime_error(
           "MultiChannelDelay::<init> Maximum delay invalid");
     }
-    if (Count<S>::product(maxChannels, maxDelay) > 0) {
+    if (maxChannels > 0 &&
+        Count<S>::product(maxChannels, Power2::next(maxDelay + 1)) > 0) {
       return maxChannels;
     }
     throw std::runtime_error("MultiChannelDelay::<init> Combination of maximum "
                              "channels and maximum delay invalid");
   }
 
-  void setMetrics(size_t channels) {
-    buffer_.zero();
-    channels_ = channels;
-    entry_.setSize(channels_);
-    for (size_t channel; channel < channels_; channel++) {
-      entry_[channel].reset(channels_, channel);
-    }
+  [[nodiscard]] inline S *line(size_t channel) noexcept {
+    return buffer_.unsafeData() + channel * capacity_;
+  }
+
+  [[nodiscard]] inline const S *line(size_t channel) const noexcept {
+    return buffer_.unsafeData() + channel * capacity_;
   }
 
 public:
   MultiChannelAndTimeDelay(size_t maxChannels, size_t maxDelay)
       : maxChannels_(getValidMaxChannels(maxChannels, maxDelay)),
-        maxDelay_(maxDelay), buffer_(maxChannels_ * (maxDelay_ + 1)),
-        entry_(maxChannels_) {
-    for (size_t channel = 0; channel < maxChannels_; channel++) {
-      entry_[channel].init(maxChannels_, channel);
-    }
+        maxDelay_(maxDelay), capacity_(Power2::next(maxDelay_ + 1)),
+        mask_(capacity_ - 1), channels_(maxChannels_), position_(0),
+        buffer_(maxChannels_ * capacity_), delay_(maxChannels_) {
     buffer_.zero();
-    channels_ = maxChannels_;
-    entry_.setSize(channels_);
+    delay_.zero();
   }
 
   void zero() { buffer_.zero(); }
@@ -225,32 +211,86 @@ public:
       throw std::runtime_error(
           "MultiChannelDelay::setChannels invalid number of channels");
     }
-    setMetrics(channels);
+    buffer_.zero();
+    channels_ = channels;
   }
 
   void setDelay(size_t channel, size_t delay) {
     if (delay > maxDelay_) {
       throw std::runtime_error("MultiChannelDelay::setChannels invalid delay");
     }
-    entry_[channel].setDelay(channels_, channel, delay);
-    delay_ = delay;
+    delay_[channel] = delay;
   }
 
-  [[nodiscard]] size_t getDelay(size_t channel) const { return entry_[channel].delay(); }
+  [[nodiscard]] size_t getDelay(size_t channel) const {
+    return delay_[channel];
+  }
 
   [[nodiscard]] size_t getChannels() const noexcept { return channels_; }
 
+  [[nodiscard]] size_t maxDelay() const noexcept { return maxDelay_; }
+
   [[nodiscard]] S setAndGet(size_t channel, S value) noexcept {
-    Entry &entry = entry_[channel];
-    buffer_[entry.write_] = value;
-    return buffer_[entry.read_];
+    S *const data = line(channel);
+    data[position_] = value;
+    return data[(position_ - delay_.unsafeData()[channel]) & mask_];
   }
 
-  void next() noexcept {
-    for (size_t channel = 0; channel < channels_; channel++) {
-      entry_[channel].next(channels_);
+  /**
+   * Writes the value for the channel at the current position, so that it can
+   * be read at one or more taps before calling next().
+   */
+  inline void set(size_t channel, S value) noexcept {
+    line(channel)[position_] = value;
+  }
+
+  /**
+   * Returns the value for the channel that was written delay samples ago,
+   * where delay must not exceed the maximum delay.
+   */
+  [[nodiscard]] inline S tap(size_t channel, size_t delay) const noexcept {
+    return line(channel)[(position_ - delay) & mask_];
+  }
+
+  void next() noexcept { position_ = (position_ + 1) & mask_; }
+
+  /**
+   * Writes frames of input to the channel and writes the delayed values to
+   * output, which may be the same as input. This does not advance the write
+   * position: after processing all channels, call next(frames).
+   */
+  void process(size_t channel, const S *input, S *output,
+               size_t frames) noexcept {
+    S *const data = line(channel);
+    const size_t delay = delay_.unsafeData()[channel];
+    // Larger blocks would overwrite samples before they are read
+    const size_t maxChunk = capacity_ - delay;
+    for (size_t done = 0; done < frames;) {
+      const size_t chunk = std::min(maxChunk, frames - done);
+      const size_t write = (position_ + done) & mask_;
+      copyIn(data, write, input + done, chunk);
+      copyOut(data, (write - delay) & mask_, output + done, chunk);
+      done += chunk;
     }
   }
+
+  void next(size_t frames) noexcept {
+    position_ = (position_ + frames) & mask_;
+  }
+
+private:
+  void copyIn(S *data, size_t start, const S *source, size_t count) noexcept {
+    const size_t first = std::min(count, capacity_ - start);
+    memcpy(data + start, source, first * sizeof(S));
+    memcpy(data, source + first, (count - first) * sizeof(S));
+  }
+
+  void copyOut(const S *data, size_t start, S *target,
+               size_t count) noexcept {
+    const size_t first = std::min(count, capacity_ - start);
+    memcpy(target, data + start, first * sizeof(S));
+    memcpy(target + first, data, (count - first) * sizeof(S));
+  }
 };
 
 } // namespace tdap
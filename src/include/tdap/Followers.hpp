@@ -23,6 +23,7 @@
  */
 
 #include <algorithm>
+#include <stdexcept>
 #include <tdap/Integration.hpp>
 #ifdef TDAP_FOLLOWERS_DEBUG_LOGGING
 #include <cstdio>
@@ -164,6 +165,61 @@ public:
   AttackReleaseFilter<C> &integrator() { return integrator_; }
 };
 
+/**
+ * Maximum of the last window samples, using a monotonic deque. Each sample is
+ * pushed and popped at most once, so the amortized cost per sample is O(1),
+ * regardless of the window size. Storage is inline and fixed, which makes the
+ * object usable in real-time context without allocation.
+ */
+template <typename T, size_t CAPACITY = 1024> class SlidingWindowMaximum {
+  static_assert(CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two larger than one");
+  static constexpr size_t MASK = CAPACITY - 1;
+
+  struct Entry {
+    T value;
+    size_t position;
+  };
+
+  Entry entry_[CAPACITY];
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t position_ = 0;
+  size_t window_ = 1;
+
+public:
+  static constexpr size_t maximumWindow = CAPACITY;
+
+  void setWindow(size_t window) {
+    if (window < 1 || window > CAPACITY) {
+      throw std::invalid_argument(
+          "SlidingWindowMaximum: window must be between one and capacity");
+    }
+    window_ = window;
+    reset();
+  }
+
+  size_t window() const noexcept { return window_; }
+
+  void reset() noexcept { head_ = tail_ = position_ = 0; }
+
+  T next(T value) noexcept {
+    // Drop the expired head first, so that a full window of CAPACITY
+    // entries never overwrites it.
+    if (tail_ != head_ &&
+        entry_[head_ & MASK].position + window_ <= position_) {
+      head_++;
+    }
+    while (tail_ != head_ && entry_[(tail_ - 1) & MASK].value <= value) {
+      tail_--;
+    }
+    entry_[tail_ & MASK] = {value, position_};
+    tail_++;
+    position_++;
+    return entry_[head_ & MASK].value;
+  }
+};
+
 template <typename T> class FastSmoothHoldFollower {
   IntegrationCoefficients<T> attack_;
   IntegrationCoefficients<T> release_;
@@ -178,6 +234,7 @@ template <typename T> class FastSmoothHoldFollower {
   T threshold_ = 1;
   size_t prediction_ = 1;
   size_t count_ = 0;
+  SlidingWindowMaximum<T> windowMaximum_;
 
   T calculateOverShoot(size_t predictionSamples) {
     T m1, m2, m3, m4;
@@ -191,9 +248,33 @@ template <typename T> class FastSmoothHoldFollower {
     return 1.0 / m4;
   }
 
+  inline T integrateHeldPeak(T holdPeak) noexcept {
+    T correctedValue = threshold_ + (holdPeak - threshold_) * overshoot_;
+    if (correctedValue > releaseInt2_) {
+      releaseInt2_ = releaseInt1_ = correctedValue;
+    } else {
+      release_.integrate(correctedValue, releaseInt1_);
+      release_.integrate(releaseInt1_, releaseInt2_);
+    }
+    attack_.integrate(releaseInt2_, attackInt1_);
+    attack_.integrate(attackInt1_, attackInt2_);
+    attack_.integrate(attackInt2_, attackInt3_);
+    attack_.integrate(attackInt3_, attackInt4_);
+
+    return attackInt4_;
+  }
+
 public:
+  static constexpr size_t maximumPrediction =
+      SlidingWindowMaximum<T>::maximumWindow - 1;
+
   void setPredictionAndThreshold(T predictionSeconds, T threshold, T sampleRate,
                                  T releaseSeconds, T initialValue = -1) {
+    size_t prediction = 0.5 + predictionSeconds * sampleRate;
+    if (prediction > maximumPrediction) {
+      throw std::invalid_argument(
+          "FastSmoothHoldFollower: prediction exceeds maximum");
+    }
     T initValue = std::clamp(initialValue, threshold, threshold * 100);
     threshold_ = threshold;
     releaseInt1_ = initValue;
@@ -203,12 +284,13 @@ public:
     attackInt3_ = initValue;
     attackInt4_ = initValue;
     holdPeak_ = initValue;
-    prediction_ = 0.5 + predictionSeconds * sampleRate;
+    prediction_ = prediction;
     attack_.setCharacteristicSamples(std::max(prediction_ / 6, 8lu));
     overshoot_ = calculateOverShoot(prediction_);
     release_.setCharacteristicSamples(sampleRate *
                                       std::clamp(releaseSeconds, 0.001, 0.1));
     count_ = 0;
+    windowMaximum_.setWindow(prediction_ + 1);
   }
 
   size_t latency() const noexcept { return prediction_; }
@@ -225,22 +307,29 @@ public:
     } else {
       holdPeak_ = limitValue;
     }
-    T correctedValue = threshold_ + (holdPeak_ - threshold_) * overshoot_;
-    if (correctedValue > releaseInt2_) {
-      releaseInt2_ = releaseInt1_ = correctedValue;
-    } else {
-      release_.integrate(correctedValue, releaseInt1_);
-      release_.integrate(releaseInt1_, releaseInt2_);
-    }
-    attack_.integrate(releaseInt2_, attackInt1_);
-    attack_.integrate(attackInt1_, attackInt2_);
-    attack_.integrate(attackInt2_, attackInt3_);
-    attack_.integrate(attackInt3_, attackInt4_);
-
-    return attackInt4_;
+    return integrateHeldPeak(holdPeak_);
   }
 
   T getGain(T sample) noexcept { return threshold() / getDetection(sample); }
+
+  /**
+   * Calculates the gains for a block of peak values. The hold is the maximum
+   * over the prediction window, which is never lower than the hold of the
+   * sample-by-sample variant, so the gains are never higher either. As the
+   * hold state is kept separately, a follower should use either this method or
+   * getDetection() and getGain() consistently.
+   * @param peaks The peak values
+   * @param gains Receives the gains and may be the same as peaks
+   * @param count The number of samples to process
+   */
+  void getGains(const T *peaks, T *gains, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+      gains[i] = windowMaximum_.next(std::max(threshold_, peaks[i]));
+    }
+    for (size_t i = 0; i < count; i++) {
+      gains[i] = threshold_ / integrateHeldPeak(gains[i]);
+    }
+  }
 };
 
 template <typename C> class SmoothHoldMaxAttackRelease {
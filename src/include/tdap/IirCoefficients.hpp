@@ -23,6 +23,7 @@
  * limitations under the License.
  */
 
+#include <complex>
 #include <cstddef>
 #include <memory>
 #include <tdap/AlignedArray.h>
@@ -693,6 +694,24 @@ public:
     return WrappedIirCoefficients<FixedSizeIirCoefficients<C, ORDER>>(*this);
   }
 
+  /**
+   * Returns the power response, the squared magnitude of the transfer
+   * function, at the frequency relative to the sample rate.
+   */
+  double getPowerResponse(double relativeFrequency) const {
+    const std::complex<double> delay =
+        std::polar(1.0, -2.0 * M_PI * relativeFrequency);
+    std::complex<double> z = 1.0;
+    std::complex<double> numerator = C_(0);
+    std::complex<double> denominator = 1.0;
+    for (size_t i = 1; i < COEFFS; i++) {
+      z *= delay;
+      numerator += double(C_(i)) * z;
+      denominator -= double(D_(i)) * z;
+    }
+    return std::norm(numerator) / std::norm(denominator);
+  }
+
 private:
   alignas(Count<C>::align()) C data[TOTAL_COEEFS];
 };
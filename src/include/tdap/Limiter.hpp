@@ -89,7 +89,7 @@ public:
 };
 
 template <typename T>
-class FastLookAheadLimiter : public Limiter<T> {
+class FastLookAheadLimiter final : public Limiter<T> {
   FastSmoothHoldFollower<T> follower;
 public:
   void setPredictionAndThreshold(size_t prediction, T threshold,
@@ -108,10 +108,14 @@ public:
   T getGain(T sample) noexcept override {
     return follower.getGain(sample);
   }
+
+  void getGains(const T *peaks, T *gains, size_t count) noexcept {
+    follower.getGains(peaks, gains, count);
+  }
 };
 
 template <typename T>
-class ZeroPredictionHardAttackLimiter : public Limiter<T> {
+class ZeroPredictionHardAttackLimiter final : public Limiter<T> {
   IntegrationCoefficients<T> release_;
   T integrated1_ = 0;
   T integrated2_ = 0;
@@ -188,6 +192,10 @@ public:
   }
 };
 
+/**
+ * Limiter that predicts peaks and creates a smooth attack envelope towards
+ * them, blending with the envelope of earlier peaks.
+ */
 template <typename sample_t> class PredictiveSmoothEnvelopeLimiter {
 
   Array<sample_t> attack_envelope_;
@@ -312,11 +320,10 @@ public:
 
   const sample_t
   limiter_submit_peak_return_amplification(sample_t samplePeakValue) {
-    static int cnt = 0;
-    const size_t prediction = attack_envelope_.size();
+    const size_t prediction = attack_samples_;
 
     const sample_t relativeValue = samplePeakValue - threshold_;
-    const int withinReleasePeriod = release_count_ < release_envelope_.size();
+    const int withinReleasePeriod = release_count_ < release_samples_;
     const sample_t releaseCurveValue =
         withinReleasePeriod ? current_peak_ * release_envelope_[release_count_]
                             : 0.0;
@@ -329,7 +336,6 @@ public:
       if (withinReleasePeriod) {
         release_count_++;
       }
-      cnt++;
       return getAmpAndMoveToNextSample(releaseCurveValue);
     }
     /**
@@ -70,6 +70,9 @@ public:
         0.5 * ((double)Rnd::min() + (double)Rnd::max());
     static constexpr double width = (double)Rnd::max() - (double)Rnd::min();
     static constexpr double unityMultiplier = 1.0 / width;
+    static constexpr double expectedRandom =
+        0.5 * (double(Rnd::min() >> RANDOM_SHIFT) +
+               double(Rnd::max() >> RANDOM_SHIFT));
 
     Rnd white_;
     int32_t random_;
@@ -87,28 +90,20 @@ public:
       random_ = white_();
       index_ = 0;
       indexMask_ = (1 << ACCURACY) - 1;
-      offset_ = 0;
       setScale(scale);
-      /* Initialize rows. */
-      for (int i = 0; i < ACCURACY; i++) {
-        rows_[i] = 0;
-      }
+      /*
+       * Start in the steady state: every row has a random value. Rows that
+       * change more slowly than the DC integration follow, are part of the
+       * DC offset as they are. The others and the extra white noise value
+       * contribute their expected value, as random values are not signed.
+       */
       runningSum_ = 0;
-      /* Stabilize around zero */
-      long positive = 0;
-      long negative = 0;
-      for (size_t i = 0; i < 19200000; i++) {
-        double result = this->operator()();
-        if (result < 0) {
-          negative++;
-        } else if (result > 0) {
-          positive++;
-        }
-        double ratio = negative > 0 ? positive / negative : 0;
-        if (ratio > 0.99 && ratio < 1.01) {
-          std::cout << "Offset stabilized in " << i << std::endl;
-          break;
-        }
+      offset_ = expectedRandom;
+      for (int i = 0; i < ACCURACY; i++) {
+        rows_[i] = white_() >> RANDOM_SHIFT;
+        runningSum_ += rows_[i];
+        size_t updatePeriod = size_t(2) << i;
+        offset_ += updatePeriod > integrationSamples ? rows_[i] : expectedRandom;
       }
     }
 
@@ -211,8 +211,10 @@ class PerceptiveRms {
   SmoothDetection<S> follower_;
 
 public:
-  PerceptiveRms()
-      : rms_(MAX_WINDOW_SAMPLES, MAX_WINDOW_SAMPLES * 10, LEVELS, 0)  {};
+  explicit PerceptiveRms(size_t maxWindowSamples)
+      : rms_(maxWindowSamples, maxWindowSamples * 10, LEVELS, 0) {}
+
+  PerceptiveRms() : PerceptiveRms(MAX_WINDOW_SAMPLES) {}
 
   void configure(size_t sample_rate, const Perceptive::Metrics &metrics,
                  S initial_value = 0.0) {
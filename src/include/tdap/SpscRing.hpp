@@ -0,0 +1,90 @@
+#ifndef TDAP_M_SPSC_RING_HPP
+#define TDAP_M_SPSC_RING_HPP
+/*
+ * tdap/SpscRing.hpp
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <tdap/Power2.hpp>
+#include <type_traits>
+
+namespace tdap {
+
+/**
+ * Lock-free ring for a single producer and a single consumer. The producer
+ * never blocks: when the ring is full, the value is dropped and counted.
+ */
+template <typename T, size_t CAPACITY> class SpscRing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Expected element type that is trivial to copy");
+  static_assert(Power2::constant::is(CAPACITY),
+                "Capacity must be a power of two");
+
+  static constexpr size_t MASK = CAPACITY - 1;
+
+  // Written by the producer, read by the consumer
+  alignas(64) std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> dropped_ = 0;
+  // Written by the consumer, read by the producer
+  alignas(64) std::atomic<size_t> tail_ = 0;
+  alignas(64) T data_[CAPACITY];
+
+public:
+  /**
+   * Adds a value, which is dropped if the ring is full.
+   * @return true if the value was added
+   */
+  bool push(const T &value) noexcept {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == CAPACITY) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    data_[head & MASK] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes up to count of the oldest values and copies them to target.
+   * @return the number of values copied
+   */
+  size_t pop(T *target, size_t count) noexcept {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t available = head_.load(std::memory_order_acquire) - tail;
+    size_t popped = available < count ? available : count;
+    for (size_t i = 0; i < popped; i++) {
+      target[i] = data_[(tail + i) & MASK];
+    }
+    tail_.store(tail + popped, std::memory_order_release);
+    return popped;
+  }
+
+  size_t dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  static constexpr size_t capacity() { return CAPACITY; }
+};
+
+} // namespace tdap
+
+#endif // TDAP_M_SPSC_RING_HPP
@@ -22,155 +22,219 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <chrono>
-#include <mutex>
-#include <tdap/MemoryFence.hpp>
-#include <thread>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <type_traits>
+#include <unistd.h>
 
 namespace tdap {
 
 using namespace std;
 
+namespace helpers_tdap {
+
+/**
+ * Waits until word no longer has the expected value, is woken or the timeout
+ * expires. Spurious wake-ups are possible.
+ */
+static inline void futexWait(atomic<uint32_t> &word, uint32_t expected,
+                             chrono::nanoseconds timeout) {
+  static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t),
+                "Futex requires an atomic with the size of its value");
+  auto seconds = chrono::duration_cast<chrono::seconds>(timeout);
+  timespec time;
+  time.tv_sec = seconds.count();
+  time.tv_nsec = (timeout - seconds).count();
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE,
+          expected, &time, nullptr, 0);
+}
+
+static inline void futexWakeAll(atomic<uint32_t> &word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE,
+          INT32_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace helpers_tdap
+
 /**
- * Defines a transport that corresponds data between a thread that is
- * required to be lock-free and a thread that is not.
+ * Wait-free triple buffer for a single writer and a single reader. The
+ * writer always has a slot to write in and the reader always gets the most
+ * recently published value; values published in between are skipped.
  */
-template <typename Data> class Transport {
+template <typename Data> class TripleBuffer {
   static_assert(is_trivially_copyable<Data>::value,
                 "Expected Data parameter that is trivial to copy");
 
-  mutex m_;
-  volatile bool read_ = false;
-  volatile bool write_ = false;
-  volatile bool shutdown_ = false;
-  Data data_[2];
+  static constexpr unsigned INDEX = 3;
+  static constexpr unsigned FRESH = 4;
+
+  Data slot_[3];
+  // Index of the slot that is neither written nor read, with FRESH if it was
+  // published and not yet taken by the reader.
+  atomic<unsigned> middle_ = 1;
+  unsigned write_ = 0;
+  unsigned read_ = 2;
 
 public:
-  class LockFreeData {
-    Data *data_;
-    bool write_;
-    volatile bool *read_;
-    bool fenced_;
-
-    LockFreeData(Data &data, const bool write, volatile bool &read,
-                 bool useFence)
-        : data_(&data) {
-      write_ = write;
-      read_ = &read;
-      fenced_ = useFence;
-    }
+  /**
+   * Returns the slot the writer can fill before calling publish().
+   */
+  Data &writeSlot() noexcept { return slot_[write_]; }
 
-  public:
-    LockFreeData(LockFreeData &&source)
-        : data_(source.data_), write_(source.write_), read_(source.read_),
-          fenced_(source.fenced_) {
-      source.data_ = nullptr;
-    }
+  void publish() noexcept {
+    write_ = middle_.exchange(write_ | FRESH, memory_order_acq_rel) & INDEX;
+  }
 
-    static LockFreeData create(Data &data, const bool write,
-                               volatile bool &read, bool useFence) {
-      if (useFence) {
-        MemoryFence::acquire();
-      }
-      return LockFreeData(data, write, read, useFence);
+  /**
+   * Makes the most recently published value available with readSlot(),
+   * if there is one.
+   * @return true if a value was published since the last call
+   */
+  bool take() noexcept {
+    if (!(middle_.load(memory_order_relaxed) & FRESH)) {
+      return false;
     }
+    read_ = middle_.exchange(read_, memory_order_acq_rel) & INDEX;
+    return true;
+  }
 
-    bool modified() const { return write_ != *read_; }
+  const Data &readSlot() const noexcept { return slot_[read_]; }
+};
 
-    Data &data() { return *data_; }
+/**
+ * Transports commands from a thread that is allowed to block to a thread
+ * that is required to be lock-free, through a triple buffer, so neither side
+ * waits for the other. The blocking side can wait for a command to be
+ * applied: the lock-free side only wakes it up with a futex if someone is
+ * actually waiting.
+ *
+ * Each side must be used by a single thread at a time.
+ */
+template <typename Command> class Transport {
+  struct CommandEntry {
+    Command command;
+    uint32_t sequence;
+  };
 
-    ~LockFreeData() {
-      if (!data_) {
-        return;
-      }
-      if (modified()) {
-        *read_ = write_;
+  TripleBuffer<CommandEntry> commands_;
+  atomic<uint32_t> applied_ = 0;
+  atomic<int> waiters_ = 0;
+  atomic<bool> shutdown_ = false;
+  // Only used by the blocking side
+  uint32_t written_ = 0;
+  // Only used by the lock-free side
+  uint32_t pending_ = 0;
+
+  static bool reached(uint32_t value, uint32_t sequence) {
+    return static_cast<int32_t>(value - sequence) >= 0;
+  }
+
+  void wake(atomic<uint32_t> &word) {
+    if (waiters_.load() > 0) {
+      helpers_tdap::futexWakeAll(word);
+    }
+  }
+
+  template <class Predicate>
+  bool await(atomic<uint32_t> &word, Predicate predicate,
+             chrono::milliseconds duration) {
+    const auto expire = chrono::steady_clock::now() + duration;
+    waiters_.fetch_add(1);
+    bool result;
+    while (true) {
+      uint32_t value = word.load();
+      if (predicate(value)) {
+        result = true;
+        break;
       }
-      if (fenced_) {
-        MemoryFence::release();
+      auto remaining = expire - chrono::steady_clock::now();
+      if (shutdown_.load() || remaining <= remaining.zero()) {
+        result = false;
+        break;
       }
+      helpers_tdap::futexWait(
+          word, value, chrono::duration_cast<chrono::nanoseconds>(remaining));
     }
-  };
+    waiters_.fetch_sub(1);
+    return result;
+  }
 
+public:
   /**
-   * Creates a transport and initialized the data with an original value.
+   * Publishes a command for the lock-free side, without waiting.
+   * @return the sequence of the command, to be used with awaitApplied()
    */
-  Transport() {}
+  uint32_t put(const Command &command) {
+    CommandEntry &entry = commands_.writeSlot();
+    entry.command = command;
+    entry.sequence = ++written_;
+    commands_.publish();
+    return entry.sequence;
+  }
 
   /**
-   * Creates a transport and initialized the data with an original value.
+   * Publishes a command that is filled in place by fill(Command &), without
+   * waiting. The slot still contains an older command, so fill can copy only
+   * what the lock-free side will look at, which is useful for large commands.
+   * @return the sequence of the command, to be used with awaitApplied()
    */
-  Transport(const Data original, bool startModified) {
-    init(original, startModified);
-  }
-
-  void init(const Data original, bool startModified) {
-    data_[0] = original;
-    data_[1] = original;
-    if (startModified) {
-      read_ = !write_;
-    }
+  template <class Fill> uint32_t fillAndPut(Fill fill) {
+    CommandEntry &entry = commands_.writeSlot();
+    fill(entry.command);
+    entry.sequence = ++written_;
+    commands_.publish();
+    return entry.sequence;
   }
 
   /**
-   * Obtain lock-free data, that will bre "released" on destruction.
-   * This call makes sure the scope of the returned object is
-   * memory fenced, i.e. a memory acquire is done on construction and
-   * a release on destruction.
+   * Returns whether the lock-free side applied the command with the sequence,
+   * or a later one.
    */
-  LockFreeData getLockFree() {
-    return LockFreeData::create(write_ ? data_[1] : data_[0], write_, read_,
-                                true);
+  bool isApplied(uint32_t sequence) const {
+    return reached(applied_.load(), sequence);
   }
 
   /**
-   * Obtain lock-free data, that will bre "released" on destruction.
-   * This call does no acquire-release memory fence and assumes that
-   * the call site is already within another memory fence that is
-   * relevant for the transport parties.
+   * Waits until the lock-free side applied the command with the sequence,
+   * or the duration expires.
    */
-  LockFreeData getLockFreeNoFence() {
-    return LockFreeData::create(write_ ? data_[1] : data_[0], write_, read_,
-                                false);
+  bool awaitApplied(uint32_t sequence, chrono::milliseconds duration) {
+    return await(
+        applied_, [sequence](uint32_t v) { return reached(v, sequence); },
+        duration);
   }
 
   /**
-   * Gets the last completely written version of the data on the
-   * non-locking half and sets it to a new value.
-   * In order to work correctly, we wait until the last
-   * set value is successfully read by the non-locking half or the
-   * duration is exceeded.
-   * The method returns true if the information was written and false
-   * if not (duration exceeded).
+   * Returns the most recent command that was not returned before, or nullptr.
+   * The command should be acknowledged with applied().
    */
-  bool getAndSet(Data set, Data &get, chrono::milliseconds duration) {
-    const chrono::microseconds sleep = duration / 10;
-    const auto expire = chrono::steady_clock::now() + duration;
-    unique_lock<mutex> lock(m_);
-
-    while (write_ != read_ && chrono::steady_clock::now() < expire &&
-           !shutdown_) {
-      this_thread::sleep_for(sleep);
-      // mutex only syncs when it is entered, not in-between
-      MemoryFence::acquire();
+  const Command *takeCommand() noexcept {
+    if (!commands_.take()) {
+      return nullptr;
     }
-    if (write_ != read_) {
-      return false;
-    }
-    Data &data = write_ ? data_[0] : data_[1];
-    get = data;
-    data = set;
-    write_ = !write_;
+    const CommandEntry &entry = commands_.readSlot();
+    pending_ = entry.sequence;
+    return &entry.command;
+  }
 
-    return true;
+  /**
+   * Acknowledges that the last taken command was applied.
+   */
+  void applied() noexcept {
+    applied_.store(pending_);
+    wake(applied_);
   }
 
+  /**
+   * Makes all current and future waits return immediately.
+   */
   void shutdown() {
-    MemoryFence fence;
-    // volatile only prevents reorder, does not guarantee inter-thread
-    // visibility
-    shutdown_ = true;
+    shutdown_.store(true);
+    helpers_tdap::futexWakeAll(applied_);
   }
 };
 
@@ -0,0 +1,137 @@
+#ifndef TDAP_M_TRUE_PEAK_HPP
+#define TDAP_M_TRUE_PEAK_HPP
+/*
+ * tdap/TruePeak.hpp
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace tdap {
+
+/**
+ * Polyphase bank of a windowed-sinc interpolation filter for four times
+ * oversampling, in the spirit of ITU-R BS.1770. The filter is centered on a
+ * sample, so phase zero reproduces the (delayed) input exactly and the other
+ * phases interpolate at a quarter, half and three quarters of a sample after
+ * that. Every phase is normalized to unity gain at DC.
+ */
+template <typename T, size_t TAPS_PER_PHASE = 12> struct TruePeakBank {
+  static_assert(std::is_floating_point<T>::value,
+                "Sample type T must be floating-point");
+  static_assert(TAPS_PER_PHASE >= 4 && TAPS_PER_PHASE % 2 == 0,
+                "Need an even number of at least four taps per phase");
+
+  static constexpr size_t OVERSAMPLING = 4;
+  static constexpr size_t TAPS = TAPS_PER_PHASE;
+  static constexpr size_t LATENCY = TAPS_PER_PHASE / 2;
+
+  alignas(32) T phase[OVERSAMPLING][TAPS_PER_PHASE];
+
+  TruePeakBank() {
+    static constexpr double center = OVERSAMPLING * LATENCY;
+    for (size_t p = 0; p < OVERSAMPLING; p++) {
+      double sum = 0;
+      for (size_t tap = 0; tap < TAPS_PER_PHASE; tap++) {
+        // tap zero applies to the newest sample
+        double n = OVERSAMPLING * tap + p;
+        double x = (n - center) / OVERSAMPLING;
+        double sinc = x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double window = 0.5 + 0.5 * cos(M_PI * (n - center) / center);
+        double value = sinc * window;
+        phase[p][tap] = value;
+        sum += value;
+      }
+      for (size_t tap = 0; tap < TAPS_PER_PHASE; tap++) {
+        phase[p][tap] /= sum;
+      }
+    }
+  }
+
+  static const TruePeakBank &instance() {
+    static const TruePeakBank bank;
+    return bank;
+  }
+};
+
+/**
+ * Estimates the true (inter-sample) peak of a group of channels, by
+ * interpolating four times oversampled values with a shared polyphase bank.
+ * The returned peak applies to the input of LATENCY samples ago, so signals
+ * that are limited with this peak must be delayed by that extra amount.
+ */
+template <typename T, size_t CHANNELS, size_t TAPS_PER_PHASE = 12>
+class TruePeakDetector {
+  using Bank = TruePeakBank<T, TAPS_PER_PHASE>;
+  static constexpr size_t TAPS = Bank::TAPS;
+
+  const Bank &bank_ = Bank::instance();
+  // History is written twice, so that the last TAPS samples are always
+  // contiguous, newest first, starting at position_.
+  alignas(32) T history_[CHANNELS][2 * TAPS];
+  size_t position_ = 0;
+
+public:
+  static constexpr size_t LATENCY = Bank::LATENCY;
+
+  TruePeakDetector() { reset(); }
+
+  void reset() {
+    std::fill_n(&history_[0][0], CHANNELS * 2 * TAPS, 0);
+    position_ = 0;
+  }
+
+  /**
+   * Adds the sample for the channel. All channels must be added before calling
+   * next().
+   */
+  inline void add(size_t channel, T sample) noexcept {
+    size_t write = position_ == 0 ? TAPS - 1 : position_ - 1;
+    history_[channel][write] = sample;
+    history_[channel][write + TAPS] = sample;
+  }
+
+  /**
+   * Moves to the next sample, after all channels were added with add(), and
+   * returns the maximum absolute interpolated value over all channels.
+   */
+  inline T next() noexcept {
+    position_ = position_ == 0 ? TAPS - 1 : position_ - 1;
+    T peak = 0;
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+      const T *window = history_[channel] + position_;
+      for (size_t p = 0; p < Bank::OVERSAMPLING; p++) {
+        const T *coefficients = bank_.phase[p];
+        T sum = 0;
+        for (size_t tap = 0; tap < TAPS; tap++) {
+          sum += coefficients[tap] * window[tap];
+        }
+        peak = std::max(peak, std::fabs(sum));
+      }
+    }
+    return peak;
+  }
+};
+
+} // namespace tdap
+
+#endif // TDAP_M_TRUE_PEAK_HPP
@@ -107,6 +107,20 @@ struct ACurves {
 
     const FixedSizeIirCoefficients<SAMPLE, 2> &curve() const { return curve_; }
 
+    /**
+     * Returns the power response of the complete curve, including the overall
+     * gain, at the frequency relative to the sample rate.
+     */
+    double getPowerResponse(double relativeFrequency) const {
+      double power = OVERALL_GAIN * OVERALL_GAIN *
+                     curve_.getPowerResponse(relativeFrequency);
+#ifdef TDAP_FULL_ACURVE
+      power *= lowPass_.getPowerResponse(relativeFrequency) *
+               highPass_.getPowerResponse(relativeFrequency);
+#endif
+      return power;
+    }
+
 #ifdef TDAP_FULL_ACURVE
 
     const FixedSizeIirCoefficients<SAMPLE, 1> &highPass() const {
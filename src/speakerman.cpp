@@ -94,8 +94,13 @@ public:
   }
 };
 
-ConsecutiveAllocatedObjectOwner<AbstractSpeakerManager> manager(100 * 1000 *
-                                                                1000);
+// Initial size of the block used to measure what the processor needs. It
+// only uses memory for what is allocated and grows if that is not enough.
+static constexpr size_t PROCESSOR_MEASURE_BYTES = 256 * 1024 * 1024;
+static constexpr size_t PROCESSOR_HEADROOM_BYTES = 1024 * 1024;
+
+std::unique_ptr<ConsecutiveAllocatedObjectOwner<AbstractSpeakerManager>>
+    manager;
 SpeakermanConfig configFileConfig;
 
 static void webServer() {
@@ -103,10 +108,10 @@ static void webServer() {
 
 
   mg_log_set("0");
-  web_server server(manager.get());
+  web_server server(manager->get());
 
   try {
-    server.run("http://0.0.0.0:8088", 1000);
+    server.run("http://0.0.0.0:8088", web_server::POLL_MILLIS);
     cout << "Web server exit" << endl;
   } catch (const std::exception &e) {
     std::cerr << "Web server error: " << e.what() << std::endl;
@@ -151,6 +156,47 @@ void display_owner_info(ConsecutiveAllocationOwner &owner,
   cout << endl;
 }
 
+/**
+ * Discards standard output while alive.
+ */
+class DiscardOutput {
+  std::streambuf *buffer_;
+
+public:
+  DiscardOutput() : buffer_(cout.rdbuf(nullptr)) {}
+
+  ~DiscardOutput() {
+    cout.rdbuf(buffer_);
+    cout.clear();
+  }
+};
+
+/**
+ * Returns the number of bytes that creating the manager for the configuration
+ * allocates, by creating it in a block that is discarded afterwards. This
+ * happens silently, as the real manager reports the same. Buffers that depend
+ * on the sample rate live in memory that the manager reserves separately.
+ */
+static size_t measure_manager_bytes(const SpeakermanConfig &config) {
+  for (size_t blockSize = PROCESSOR_MEASURE_BYTES;; blockSize *= 2) {
+    size_t allocated;
+    bool consecutive;
+    {
+      DiscardOutput discard;
+      ConsecutiveAllocatedObjectOwner<AbstractSpeakerManager> measure(
+          blockSize, false);
+      measure.generate<AbstractSpeakerManager, const SpeakermanConfig &>(
+          createManager, config);
+      allocated = measure.get_allocated_bytes();
+      consecutive = measure.is_consecutive();
+    }
+    if (consecutive) {
+      cout << "Processor measurement: " << allocated << " bytes" << endl;
+      return allocated;
+    }
+  }
+}
+
 int main(int count, char *arguments[]) {
 
   cout << "Executing " << arguments[0] << endl;
@@ -170,18 +216,28 @@ int main(int count, char *arguments[]) {
   jack::AwaitThreadFinishedAfterExit await(5000, "Await thread shutdown...");
   MemoryFence::release();
 
-  manager.generate<AbstractSpeakerManager, const SpeakermanConfig &>(
-      createManager, configFileConfig);
-
-  display_owner_info(manager, "Processor");
-
   ConsecutiveAllocatedObjectOwner<jack::JackClient> clientOwner(4048576);
 
   clientOwner.generate(create_client, "Speaker manager");
 
   display_owner_info(clientOwner, "Jack client");
 
-  clientOwner.get().setProcessor(manager.get());
+  double sampleRate = clientOwner.get().getSampleRate();
+  size_t managerBytes = measure_manager_bytes(configFileConfig);
+  manager = std::make_unique<
+      ConsecutiveAllocatedObjectOwner<AbstractSpeakerManager>>(
+      managerBytes + managerBytes / 8 + PROCESSOR_HEADROOM_BYTES);
+  manager->generate<AbstractSpeakerManager, const SpeakermanConfig &>(
+      createManager, configFileConfig);
+  manager->get().reserveBufferMemory();
+  manager->get().prepareBuffers(sampleRate);
+  if (!manager->lock_memory()) {
+    cerr << "Could not lock processor memory" << endl;
+  }
+
+  display_owner_info(*manager, "Processor");
+
+  clientOwner.get().setProcessor(manager->get());
 
   std::cout << "activate..." << std::endl;
   clientOwner.get().setActive();
@@ -0,0 +1,76 @@
+/*
+ * speakerman/BenchmarkLimiters.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the cost per sample of PredictiveSmoothEnvelopeLimiter for worst
+ * case peaks: peaks that rise faster than the attack envelope, so that every
+ * new peak blends over (nearly) the complete prediction range.
+ *
+ * Usage: benchmark_limiters [samples]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <tdap/Array.hpp>
+#include <tdap/Limiter.hpp>
+#include <vector>
+
+namespace {
+
+constexpr double THRESHOLD = 0.5;
+
+std::vector<double> createWorstCasePeaks(size_t prediction, size_t count) {
+  std::vector<double> peaks(count);
+  double rise = 2 * M_PI / prediction;
+  for (size_t i = 0; i < count; i++) {
+    peaks[i] = THRESHOLD + exp(rise * (i % (4 * prediction)));
+  }
+  return peaks;
+}
+
+} // namespace
+
+int main(int count, char *arguments[]) {
+  size_t samples = count > 1 ? strtoul(arguments[1], nullptr, 10) : 500000;
+  if (samples == 0) {
+    fprintf(stderr, "Usage: %s [samples]\n", arguments[0]);
+    return 1;
+  }
+  for (size_t prediction : {64, 256, 512, 1024, 2048, 4096}) {
+    std::vector<double> peaks = createWorstCasePeaks(prediction, samples);
+    tdap::PredictiveSmoothEnvelopeLimiter<double> limiter(THRESHOLD, 2,
+                                                          prediction, 1);
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (double peak : peaks) {
+      sum += limiter.limiter_submit_peak_return_amplification(peak);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double nanos =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    printf("prediction %5zu: %8.1lf ns/sample (checksum %lf)\n", prediction,
+           nanos / samples, sum);
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * speakerman/LoadTestWebServer.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures request latency of a running speakerman web server under
+ * concurrent clients. Each client uses one keep-alive connection and sends its
+ * next request as soon as the previous reply arrived.
+ *
+ * Usage: load_test_webserver [url [clients [requests-per-client]]]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mongoose.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+struct LoadTest {
+  const char *url;
+  size_t clients;
+  size_t requests;
+  size_t finished = 0;
+  size_t failed = 0;
+  std::vector<double> latencies;
+};
+
+struct Client {
+  LoadTest *test;
+  size_t sent = 0;
+  Clock::time_point sentAt;
+  bool done = false;
+};
+
+void sendRequest(mg_connection *connection, Client &client) {
+  mg_str host = mg_url_host(client.test->url);
+  mg_printf(connection,
+            "GET %s HTTP/1.1\r\nHost: %.*s\r\nConnection: keep-alive\r\n\r\n",
+            mg_url_uri(client.test->url), (int)host.len, host.ptr);
+  client.sentAt = Clock::now();
+  client.sent++;
+}
+
+void finish(mg_connection *connection, Client &client) {
+  if (!client.done) {
+    client.done = true;
+    client.test->finished++;
+  }
+  connection->is_closing = 1;
+}
+
+void handle(mg_connection *connection, int event, void *eventData,
+            void *data) {
+  Client &client = *static_cast<Client *>(data);
+  switch (event) {
+  case MG_EV_CONNECT:
+    sendRequest(connection, client);
+    break;
+  case MG_EV_HTTP_MSG: {
+    auto *message = static_cast<mg_http_message *>(eventData);
+    client.test->latencies.push_back(millisSince(client.sentAt));
+    // In a reply, the status code is parsed as the URI
+    if (atoi(message->uri.ptr) != 200) {
+      client.test->failed++;
+    }
+    if (client.sent < client.test->requests) {
+      sendRequest(connection, client);
+    } else {
+      finish(connection, client);
+    }
+    break;
+  }
+  case MG_EV_ERROR:
+    client.test->failed++;
+    finish(connection, client);
+    break;
+  case MG_EV_CLOSE:
+    if (!client.done) {
+      client.done = true;
+      client.test->finished++;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+double percentile(const std::vector<double> &sorted, double fraction) {
+  size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+} // namespace
+
+int main(int count, char *arguments[]) {
+  LoadTest test;
+  test.url = count > 1 ? arguments[1] : "http://127.0.0.1:8088/levels";
+  test.clients = count > 2 ? strtoul(arguments[2], nullptr, 10) : 8;
+  test.requests = count > 3 ? strtoul(arguments[3], nullptr, 10) : 200;
+  if (test.clients == 0 || test.requests == 0) {
+    fprintf(stderr, "Usage: %s [url [clients [requests-per-client]]]\n",
+            arguments[0]);
+    return 1;
+  }
+  test.latencies.reserve(test.clients * test.requests);
+
+  mg_log_set("0");
+  mg_mgr manager;
+  mg_mgr_init(&manager);
+  std::vector<Client> clients(test.clients, Client{&test});
+  Clock::time_point start = Clock::now();
+  for (Client &client : clients) {
+    if (mg_http_connect(&manager, test.url, handle, &client) == nullptr) {
+      test.failed++;
+      test.finished++;
+      client.done = true;
+    }
+  }
+  while (test.finished < test.clients) {
+    mg_mgr_poll(&manager, 10);
+  }
+  double elapsed = millisSince(start);
+  mg_mgr_free(&manager);
+
+  printf("%zu clients, %zu replies, %zu failures in %.0lf ms\n",
+         test.clients, test.latencies.size(), test.failed, elapsed);
+  if (test.latencies.empty()) {
+    return 1;
+  }
+  std::sort(test.latencies.begin(), test.latencies.end());
+  printf("latency ms: min=%.2lf median=%.2lf p90=%.2lf p99=%.2lf max=%.2lf\n",
+         test.latencies.front(), percentile(test.latencies, 0.5),
+         percentile(test.latencies, 0.9), percentile(test.latencies, 0.99),
+         test.latencies.back());
+  printf("throughput: %.1lf requests/s\n",
+         elapsed > 0 ? 1000.0 * test.latencies.size() / elapsed : 0.0);
+  return test.failed == 0 ? 0 : 2;
+}
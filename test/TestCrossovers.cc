@@ -0,0 +1,100 @@
+/*
+ * speakerman/TestCrossovers.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <cmath>
+#include <iostream>
+#include <tdap/Crossovers.hpp>
+#include <tdap/Noise.hpp>
+
+using namespace tdap;
+
+namespace {
+
+/**
+ * Measures the unweighted band weights by running band-limited pink noise
+ * through the crossover filters.
+ */
+template <size_t CROSSOVERS>
+FixedSizeArray<double, CROSSOVERS + 1>
+simulatedWeights(const FixedSizeArray<double, CROSSOVERS> &crossovers,
+                 double sampleRate) {
+  PinkNoise::Default noise(1.0, sampleRate / 20);
+  Crossovers::Filter<double, double, 1, CROSSOVERS> crossover;
+  crossover.configure(sampleRate, crossovers);
+  FixedSizeIirCoefficientFilter<double, 1, 4> cutoffLow;
+  auto llCoeffs = cutoffLow.coefficients_.wrap();
+  Butterworth::create(llCoeffs, sampleRate, 20.0, Butterworth::Pass::HIGH,
+                      1.0);
+  FixedSizeIirCoefficientFilter<double, 1, 4> cutoffHigh;
+  auto hhCoeffs = cutoffHigh.coefficients_.wrap();
+  Butterworth::create(hhCoeffs, sampleRate, 8000.0, Butterworth::Pass::LOW,
+                      1.0);
+  cutoffLow.reset();
+  cutoffHigh.reset();
+
+  FixedSizeArray<double, CROSSOVERS + 1> y;
+  for (size_t band = 0; band <= CROSSOVERS; band++) {
+    y[band] = 0;
+  }
+  double total = 0;
+  FixedSizeArray<double, 1> input;
+  for (size_t sample = 0; sample < 10 * sampleRate; sample++) {
+    input[0] = cutoffHigh.filter(0, cutoffLow.filter(0, noise()));
+    total += input[0] * input[0];
+    const auto &bands = crossover.filter(input);
+    for (size_t band = 0; band <= CROSSOVERS; band++) {
+      y[band] += bands[band] * bands[band];
+    }
+  }
+  for (size_t band = 0; band <= CROSSOVERS; band++) {
+    y[band] = sqrt(y[band] / total);
+  }
+  return y;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testCrossovers)
+
+BOOST_AUTO_TEST_CASE(testCalculatedWeightsMatchSimulatedPinkNoise) {
+  static constexpr double sampleRate = 44100;
+  FixedSizeArray<double, 2> crossovers;
+  crossovers[0] = 80;
+  crossovers[1] = 1000;
+  auto calculated = Crossovers::weights(crossovers, sampleRate);
+  auto simulated = simulatedWeights(crossovers, sampleRate);
+  for (size_t band = 0; band < 3; band++) {
+    BOOST_CHECK_CLOSE(calculated[2 * band], simulated[band], 5.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testUnweightedWeightsDoNotDependOnSampleRate) {
+  FixedSizeArray<double, 1> crossovers;
+  crossovers[0] = 120;
+  auto weights44 = Crossovers::weights(crossovers, 44100);
+  auto weights96 = Crossovers::weights(crossovers, 96000);
+  for (size_t i = 0; i < weights44.size(); i += 2) {
+    BOOST_CHECK_CLOSE(weights44[i], weights96[i], 1.0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
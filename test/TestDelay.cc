@@ -0,0 +1,112 @@
+/*
+ * speakerman/TestDelay.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <tdap/Delay.hpp>
+#include <vector>
+
+using Delay = tdap::MultiChannelAndTimeDelay<double>;
+
+namespace {
+
+constexpr size_t CHANNELS = 3;
+constexpr size_t MAX_DELAY = 100;
+constexpr size_t DELAYS[CHANNELS] = {0, 37, MAX_DELAY};
+
+double inputValue(size_t channel, size_t frame) {
+  return 1.0 + frame + 0.25 * channel;
+}
+
+double expectedValue(size_t channel, size_t frame) {
+  return frame < DELAYS[channel] ? 0.0
+                                 : inputValue(channel, frame - DELAYS[channel]);
+}
+
+void configure(Delay &delay) {
+  for (size_t channel = 0; channel < CHANNELS; channel++) {
+    delay.setDelay(channel, DELAYS[channel]);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testDelay)
+
+BOOST_AUTO_TEST_CASE(testPerSampleDelays) {
+  Delay delay(CHANNELS, MAX_DELAY);
+  configure(delay);
+  for (size_t frame = 0; frame < 1000; frame++) {
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+      double value = delay.setAndGet(channel, inputValue(channel, frame));
+      BOOST_REQUIRE_EQUAL(value, expectedValue(channel, frame));
+    }
+    delay.next();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBlockDelaysWithVaryingBlockSizes) {
+  const size_t blockSizes[] = {1, 7, 64, 128, 300, 29};
+  Delay delay(CHANNELS, MAX_DELAY);
+  configure(delay);
+  std::vector<double> block;
+  size_t frame = 0;
+  for (size_t size : blockSizes) {
+    block.resize(size);
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+      for (size_t i = 0; i < size; i++) {
+        block[i] = inputValue(channel, frame + i);
+      }
+      delay.process(channel, block.data(), block.data(), size);
+      for (size_t i = 0; i < size; i++) {
+        BOOST_REQUIRE_EQUAL(block[i], expectedValue(channel, frame + i));
+      }
+    }
+    delay.next(size);
+    frame += size;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBlockAndPerSampleCanBeMixed) {
+  Delay delay(CHANNELS, MAX_DELAY);
+  configure(delay);
+  double block[50];
+  size_t frame = 0;
+  for (size_t round = 0; round < 10; round++) {
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+      for (size_t i = 0; i < 50; i++) {
+        block[i] = inputValue(channel, frame + i);
+      }
+      delay.process(channel, block, block, 50);
+      BOOST_REQUIRE_EQUAL(block[49], expectedValue(channel, frame + 49));
+    }
+    delay.next(50);
+    frame += 50;
+    for (size_t i = 0; i < 13; i++, frame++) {
+      for (size_t channel = 0; channel < CHANNELS; channel++) {
+        double value = delay.setAndGet(channel, inputValue(channel, frame));
+        BOOST_REQUIRE_EQUAL(value, expectedValue(channel, frame));
+      }
+      delay.next();
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+/*
+ * speakerman/TestLevelHistory.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <cstdio>
+#include <speakerman/LevelHistory.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using speakerman::DynamicProcessorLevels;
+using speakerman::LevelHistory;
+using speakerman::LevelHistoryBucket;
+using Resolution = speakerman::LevelHistory::Resolution;
+
+namespace {
+
+constexpr long long START_SECONDS = 1800000000;
+
+DynamicProcessorLevels levels(double signal) {
+  DynamicProcessorLevels result(1);
+  // The constructor leaves the levels uninitialized
+  result.reset();
+  result.addValues(1, signal * signal);
+  result.next();
+  return result;
+}
+
+/**
+ * Adds levels every 50 milliseconds, where the signal alternates between
+ * 0.25 and 0.75.
+ */
+void addLevels(LevelHistory &history, long long seconds) {
+  long long start = START_SECONDS * 1000;
+  for (long long millis = 0; millis < seconds * 1000; millis += 50) {
+    history.add(start + millis, levels((millis / 50) % 2 ? 0.75 : 0.25));
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testLevelHistory)
+
+BOOST_AUTO_TEST_CASE(testSecondBucketStatistics) {
+  LevelHistory history(nullptr);
+  addLevels(history, 10);
+  std::vector<LevelHistoryBucket> buckets;
+  history.query(START_SECONDS, START_SECONDS + 100, Resolution::Seconds,
+                buckets);
+  BOOST_REQUIRE_EQUAL(buckets.size(), 10);
+  const LevelHistoryBucket &bucket = buckets[3];
+  BOOST_CHECK_EQUAL(bucket.start, START_SECONDS + 3);
+  BOOST_CHECK_EQUAL(bucket.samples, 20);
+  BOOST_CHECK_EQUAL(bucket.levels, 2);
+  BOOST_CHECK_CLOSE(bucket.level[1].minimum, 0.25, 1e-4);
+  BOOST_CHECK_CLOSE(bucket.level[1].maximum, 0.75, 1e-4);
+  BOOST_CHECK_CLOSE(bucket.level[1].sum / bucket.samples, 0.5, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(testMinuteBuckets) {
+  LevelHistory history(nullptr);
+  addLevels(history, 150);
+  std::vector<LevelHistoryBucket> buckets;
+  history.query(START_SECONDS - 60, START_SECONDS + 150, Resolution::Minutes,
+                buckets);
+  BOOST_REQUIRE_EQUAL(buckets.size(), 3);
+  BOOST_CHECK_EQUAL(buckets[0].start, START_SECONDS);
+  BOOST_CHECK_EQUAL(buckets[1].start, START_SECONDS + 60);
+  BOOST_CHECK_EQUAL(buckets[1].samples, 1200);
+  BOOST_CHECK_EQUAL(buckets[2].samples, 600);
+}
+
+BOOST_AUTO_TEST_CASE(testOnlyLastHourPerSecond) {
+  LevelHistory history(nullptr);
+  addLevels(history, LevelHistory::SECOND_BUCKETS + 10);
+  std::vector<LevelHistoryBucket> buckets;
+  long long to = START_SECONDS + 2 * LevelHistory::SECOND_BUCKETS;
+  history.query(START_SECONDS, to, Resolution::Seconds, buckets);
+  BOOST_REQUIRE_EQUAL(buckets.size(), LevelHistory::SECOND_BUCKETS);
+  BOOST_CHECK_EQUAL(buckets.front().start, START_SECONDS + 10);
+  BOOST_CHECK_EQUAL(buckets.back().start,
+                    START_SECONDS + LevelHistory::SECOND_BUCKETS + 9);
+}
+
+BOOST_AUTO_TEST_CASE(testHistoryPersists) {
+  std::string fileName = "/tmp/speakerman-test-history-";
+  fileName += std::to_string(getpid());
+  {
+    LevelHistory history(fileName.c_str());
+    BOOST_CHECK(history.persistent());
+    addLevels(history, 5);
+  }
+  std::vector<LevelHistoryBucket> buckets;
+  {
+    LevelHistory history(fileName.c_str());
+    history.query(START_SECONDS, START_SECONDS + 10, Resolution::Seconds,
+                  buckets);
+  }
+  std::remove(fileName.c_str());
+  BOOST_CHECK_EQUAL(buckets.size(), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
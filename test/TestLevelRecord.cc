@@ -0,0 +1,140 @@
+/*
+ * speakerman/TestLevelRecord.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <bit>
+#include <memory>
+#include <speakerman/LevelRecord.h>
+#include <vector>
+
+using speakerman::DynamicProcessorLevels;
+using speakerman::LevelRecord;
+using speakerman::LevelRecordRing;
+
+namespace {
+
+uint64_t readLittleEndian(const std::string &data, size_t offset,
+                          size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    value |= uint64_t(uint8_t(data[offset + i])) << (8 * i);
+  }
+  return value;
+}
+
+float readFloat(const std::string &data, size_t offset) {
+  return std::bit_cast<float>(uint32_t(readLittleEndian(data, offset, 4)));
+}
+
+LevelRecord record(uint64_t sequence) {
+  DynamicProcessorLevels levels(1);
+  levels.reset();
+  levels.addValues(1, 0.25);
+  levels.next();
+  LevelRecord result;
+  result.set(sequence, 1000 + sequence, levels, 2.0, 10.0, 20.0);
+  return result;
+}
+
+std::vector<uint64_t> sequences(const std::string &reply) {
+  std::vector<uint64_t> result;
+  size_t count = readLittleEndian(reply, 8, 4);
+  for (size_t i = 0; i < count; i++) {
+    result.push_back(readLittleEndian(
+        reply, LevelRecordRing::REPLY_HEADER_BYTES + i * LevelRecord::BYTES,
+        8));
+  }
+  return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testLevelRecord)
+
+BOOST_AUTO_TEST_CASE(testRecordLayout) {
+  LevelRecordRing ring;
+  ring.put(record(7));
+  std::string reply;
+  BOOST_CHECK_EQUAL(ring.writeLatest(reply), 1);
+  BOOST_CHECK_EQUAL(reply.size(),
+                    LevelRecordRing::REPLY_HEADER_BYTES + LevelRecord::BYTES);
+  BOOST_CHECK_EQUAL(reply.substr(0, 4), "SPKL");
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, 4, 2), LevelRecordRing::VERSION);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, 6, 2), LevelRecord::BYTES);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, 12, 2), LevelRecord::MAX_LEVELS);
+
+  size_t r = LevelRecordRing::REPLY_HEADER_BYTES;
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, r, 8), 7);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, r + 8, 8), 1007);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, r + 16, 4), 1);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, r + 20, 2), 2);
+  BOOST_CHECK_EQUAL(readFloat(reply, r + 24), 2.0f);
+  BOOST_CHECK_EQUAL(readFloat(reply, r + 28), 10.0f);
+  BOOST_CHECK_EQUAL(readFloat(reply, r + 32), 20.0f);
+  size_t group = r + LevelRecord::HEADER_BYTES + LevelRecord::LEVEL_BYTES;
+  BOOST_CHECK_EQUAL(readFloat(reply, group), 0.5f);
+  BOOST_CHECK_EQUAL(readFloat(reply, group + 8), 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(testOnlyNewRecordsSinceSequence) {
+  LevelRecordRing ring;
+  for (uint64_t sequence = 1; sequence <= 5; sequence++) {
+    ring.put(record(sequence));
+  }
+  std::string reply;
+  BOOST_CHECK_EQUAL(ring.writeSince(3, reply), 2);
+  BOOST_CHECK((sequences(reply) == std::vector<uint64_t>{4, 5}));
+  BOOST_CHECK_EQUAL(ring.writeSince(5, reply), 0);
+  BOOST_CHECK_EQUAL(reply.size(), LevelRecordRing::REPLY_HEADER_BYTES);
+}
+
+BOOST_AUTO_TEST_CASE(testOverwrittenRecordsAreSkipped) {
+  std::unique_ptr<LevelRecordRing> ring(new LevelRecordRing);
+  uint64_t last = LevelRecordRing::SIZE + 10;
+  for (uint64_t sequence = 1; sequence <= last; sequence++) {
+    ring->put(record(sequence));
+  }
+  std::string reply;
+  BOOST_CHECK_EQUAL(ring->writeSince(0, reply), LevelRecordRing::SIZE);
+  std::vector<uint64_t> result = sequences(reply);
+  BOOST_CHECK_EQUAL(result.front(), 11);
+  BOOST_CHECK_EQUAL(result.back(), last);
+}
+
+BOOST_AUTO_TEST_CASE(testSequenceOfEarlierRunGetsLatest) {
+  LevelRecordRing ring;
+  for (uint64_t sequence = 1; sequence <= 5; sequence++) {
+    ring.put(record(sequence));
+  }
+  std::string reply;
+  BOOST_CHECK_EQUAL(ring.writeSince(5, reply), 0);
+  BOOST_REQUIRE_EQUAL(ring.writeSince(1000, reply), 1);
+  BOOST_CHECK_EQUAL(sequences(reply)[0], 5);
+}
+
+BOOST_AUTO_TEST_CASE(testEmptyRing) {
+  LevelRecordRing ring;
+  std::string reply;
+  BOOST_CHECK_EQUAL(ring.writeLatest(reply), 0);
+  BOOST_CHECK_EQUAL(readLittleEndian(reply, 8, 4), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,120 @@
+/*
+ * speakerman/TestLimiterFaultCapture.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <memory>
+#include <speakerman/LimiterFaultCapture.h>
+#include <sstream>
+
+using Capture = speakerman::LimiterFaultCapture<3>;
+using Snapshot = speakerman::LimiterFaultSnapshot;
+
+namespace {
+
+/**
+ * Adds samples with increasing peak values to all limiters, where the output
+ * of the given limiter exceeds the threshold at the fault sample.
+ */
+void addSamples(Capture &capture, size_t count, size_t faultLimiter,
+                size_t faultSample) {
+  for (size_t i = 0; i < count; i++) {
+    for (size_t limiter = 0; limiter < 3; limiter++) {
+      double output =
+          limiter == faultLimiter && i == faultSample ? 1.5 : 0.5;
+      capture.add(limiter, i, 1.0, output);
+    }
+    capture.next();
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testLimiterFaultCapture)
+
+BOOST_AUTO_TEST_CASE(testNothingCapturedWithoutFault) {
+  std::unique_ptr<Capture> capture(new Capture);
+  capture->configure(48000, 1.0, 48);
+  addSamples(*capture, 10000, 3, 0);
+  std::unique_ptr<Snapshot> snapshot(new Snapshot);
+  BOOST_CHECK(!capture->fetch(*snapshot));
+}
+
+BOOST_AUTO_TEST_CASE(testPreAndPostWindowAroundFault) {
+  std::unique_ptr<Capture> capture(new Capture);
+  capture->configure(48000, 1.0, 48);
+  addSamples(*capture, 1500, 2, 1200);
+
+  std::unique_ptr<Snapshot> snapshot(new Snapshot);
+  BOOST_REQUIRE(!capture->fetch(*snapshot));
+  addSamples(*capture, 1000, 3, 0);
+  BOOST_REQUIRE(capture->fetch(*snapshot));
+  BOOST_CHECK(!capture->fetch(*snapshot));
+
+  BOOST_CHECK_EQUAL(snapshot->limiter, 2);
+  BOOST_CHECK_EQUAL(snapshot->faultSample, 1200);
+  BOOST_CHECK_EQUAL(snapshot->latency, 48);
+  size_t fault = Snapshot::PRE_SAMPLES - 1;
+  BOOST_CHECK_EQUAL(snapshot->entry[fault].output, 1.5f);
+  BOOST_CHECK_EQUAL(snapshot->entry[fault].peak, 1200.0f);
+  BOOST_CHECK_EQUAL(snapshot->entry[0].peak, 1200.0f - fault);
+  // Post window continues with the second run of samples
+  BOOST_CHECK_EQUAL(snapshot->entry[fault + 299].peak, 1499.0f);
+  BOOST_CHECK_EQUAL(snapshot->entry[fault + 300].peak, 0.0f);
+  BOOST_CHECK_EQUAL(snapshot->entry[Snapshot::SAMPLES - 1].peak, 724.0f);
+
+  std::ostringstream csv;
+  snapshot->writeCsv(csv);
+  BOOST_CHECK(csv.str().find("\n0,1200,1,1.5\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testFaultsAreMissedWhenAllSnapshotsAreTaken) {
+  std::unique_ptr<Capture> capture(new Capture);
+  capture->configure(48000, 1.0, 48);
+  for (size_t i = 0; i < 6; i++) {
+    addSamples(*capture, 3000, 1, 10);
+  }
+  BOOST_CHECK_EQUAL(capture->missed(), 2);
+  std::unique_ptr<Snapshot> snapshot(new Snapshot);
+  unsigned long long sequence = 0;
+  size_t count = 0;
+  while (capture->fetch(*snapshot)) {
+    BOOST_CHECK_GT(snapshot->sequence, sequence);
+    sequence = snapshot->sequence;
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, 4);
+}
+
+BOOST_AUTO_TEST_CASE(testFaultsOnOtherLimitersAreMissedWhileCapturing) {
+  std::unique_ptr<Capture> capture(new Capture);
+  capture->configure(48000, 1.0, 48);
+  addSamples(*capture, 10, 1, 5);
+  addSamples(*capture, 10, 2, 5);
+  BOOST_CHECK_EQUAL(capture->missed(), 1);
+
+  addSamples(*capture, 3000, 3, 0);
+  std::unique_ptr<Snapshot> snapshot(new Snapshot);
+  BOOST_REQUIRE(capture->fetch(*snapshot));
+  BOOST_CHECK_EQUAL(snapshot->limiter, 1);
+  BOOST_CHECK(!capture->fetch(*snapshot));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,170 @@
+/*
+ * speakerman/TestLimiters.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <cmath>
+#include <random>
+#include <tdap/Array.hpp>
+#include <tdap/Limiter.hpp>
+#include <vector>
+
+namespace {
+
+constexpr double SAMPLE_RATE = 96000;
+constexpr double THRESHOLD = 0.5;
+constexpr size_t PREDICTION = 96;
+
+std::vector<double> createPeaks(size_t count) {
+  std::vector<double> peaks(count);
+  std::minstd_rand random(1);
+  std::uniform_real_distribution<double> distribution(0, 1);
+  for (size_t i = 0; i < count; i++) {
+    double envelope = 0.5 + 0.5 * sin(2 * M_PI * i / 4800.0);
+    peaks[i] = distribution(random) * envelope * 1.5;
+    if (i % 1333 == 0) {
+      peaks[i] = 4.0;
+    }
+  }
+  return peaks;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testLimiters)
+
+BOOST_AUTO_TEST_CASE(testSlidingWindowMaximumMatchesBruteForce) {
+  std::vector<double> decreasing(100);
+  for (size_t i = 0; i < decreasing.size(); i++) {
+    decreasing[i] = 100.0 - i;
+  }
+  // A window of the full capacity is the boundary case, where the deque is
+  // full with strictly decreasing input.
+  for (size_t window : {size_t(7), size_t(16)}) {
+    for (const std::vector<double> &peaks : {createPeaks(1000), decreasing}) {
+      tdap::SlidingWindowMaximum<double, 16> maximum;
+      maximum.setWindow(window);
+      for (size_t i = 0; i < peaks.size(); i++) {
+        double expected = 0;
+        for (size_t j = i >= window - 1 ? i - window + 1 : 0; j <= i; j++) {
+          expected = std::max(expected, peaks[j]);
+        }
+        BOOST_CHECK_EQUAL(maximum.next(peaks[i]), expected);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSlidingWindowMaximumRejectsTooLargeWindow) {
+  tdap::SlidingWindowMaximum<double, 16> maximum;
+  BOOST_CHECK_THROW(maximum.setWindow(17), std::invalid_argument);
+  BOOST_CHECK_THROW(maximum.setWindow(0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(testFastLookAheadBlockMatchesScalar) {
+  tdap::FastLookAheadLimiter<double> scalar;
+  tdap::FastLookAheadLimiter<double> block;
+  scalar.setPredictionAndThreshold(PREDICTION, THRESHOLD, SAMPLE_RATE);
+  block.setPredictionAndThreshold(PREDICTION, THRESHOLD, SAMPLE_RATE);
+
+  std::vector<double> peaks = createPeaks(48000);
+  std::vector<double> gains(peaks.size());
+  static constexpr size_t PERIOD = 256;
+  for (size_t offset = 0; offset < peaks.size(); offset += PERIOD) {
+    block.getGains(peaks.data() + offset, gains.data() + offset,
+                   std::min(PERIOD, peaks.size() - offset));
+  }
+
+  double maxDifference = 0;
+  for (size_t i = 0; i < peaks.size(); i++) {
+    double scalarGain = scalar.getGain(peaks[i]);
+    BOOST_REQUIRE_LE(gains[i], scalarGain + 1e-12);
+    maxDifference = std::max(maxDifference, scalarGain - gains[i]);
+  }
+  BOOST_CHECK_LT(maxDifference, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(testFastLookAheadBlockKeepsOutputUnderThreshold) {
+  tdap::FastLookAheadLimiter<double> limiter;
+  limiter.setPredictionAndThreshold(PREDICTION, THRESHOLD, SAMPLE_RATE);
+  std::vector<double> peaks = createPeaks(48000);
+  std::vector<double> gains(peaks.size());
+  limiter.getGains(peaks.data(), gains.data(), peaks.size());
+
+  for (size_t i = 0; i + PREDICTION < peaks.size(); i++) {
+    BOOST_REQUIRE_LE(peaks[i] * gains[i + PREDICTION], THRESHOLD * 1.0001);
+  }
+}
+
+namespace {
+
+/**
+ * Checks that no output sample exceeds the threshold.
+ */
+void runPredictiveSmoothEnvelopeLimiter(size_t prediction, size_t release,
+                                        const std::vector<double> &peaks) {
+  tdap::PredictiveSmoothEnvelopeLimiter<double> limiter(THRESHOLD, 2,
+                                                        prediction, release);
+  double maxOutput = 0;
+  for (size_t i = 0; i < peaks.size(); i++) {
+    double gain = limiter.limiter_submit_peak_return_amplification(peaks[i]);
+    if (i >= prediction) {
+      maxOutput = std::max(maxOutput, gain * peaks[i - prediction]);
+    }
+  }
+  BOOST_CHECK_LE(maxOutput, THRESHOLD * 1.000001);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testPredictiveSmoothEnvelopeKeepsOutputUnderThreshold) {
+  std::vector<double> peaks = createPeaks(48000);
+  for (size_t prediction : {1lu, 2lu, 7lu, 96lu, 1000lu}) {
+    runPredictiveSmoothEnvelopeLimiter(prediction, 4800, peaks);
+  }
+}
+
+namespace {
+
+/**
+ * Peaks that rise faster than the attack envelope, so that every new peak
+ * clashes with the existing prediction as late as possible and the blend
+ * covers (nearly) the complete prediction range. Each rise is followed by a
+ * sudden drop to start over.
+ */
+std::vector<double> createWorstCasePeaks(size_t prediction, size_t count) {
+  std::vector<double> peaks(count);
+  double rise = 2 * M_PI / prediction;
+  for (size_t i = 0; i < count; i++) {
+    peaks[i] = THRESHOLD + exp(rise * (i % (4 * prediction)));
+  }
+  return peaks;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testPredictiveSmoothEnvelopeWorstCaseUnderThreshold) {
+  for (size_t prediction : {64lu, 2048lu}) {
+    runPredictiveSmoothEnvelopeLimiter(
+        prediction, 1, createWorstCasePeaks(prediction, 3 * 4 * prediction));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * speakerman/TestNoise.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <cmath>
+#include <tdap/IirButterworth.hpp>
+#include <tdap/Noise.hpp>
+
+using namespace tdap;
+
+namespace {
+
+constexpr double SAMPLE_RATE = 48000;
+
+struct Moments {
+  double mean = 0;
+  double rms = 0;
+};
+
+Moments measure(PinkNoise::Default &noise, size_t samples) {
+  double sum = 0;
+  double squares = 0;
+  for (size_t i = 0; i < samples; i++) {
+    double x = noise();
+    sum += x;
+    squares += x * x;
+  }
+  return {sum / samples, sqrt(squares / samples)};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testNoise)
+
+BOOST_AUTO_TEST_CASE(testPinkNoiseStartsWithoutOffset) {
+  PinkNoise::Default noise(1.0, SAMPLE_RATE / 20);
+  Moments start = measure(noise, SAMPLE_RATE);
+  measure(noise, 10 * SAMPLE_RATE);
+  Moments settled = measure(noise, SAMPLE_RATE);
+
+  // Low frequencies make the mean over a second wander a bit anyway
+  BOOST_CHECK_SMALL(start.mean, 0.25 * settled.rms);
+  BOOST_CHECK_CLOSE(start.rms, settled.rms, 20.0);
+}
+
+BOOST_AUTO_TEST_CASE(testPinkNoiseHasEqualPowerPerOctave) {
+  static constexpr size_t OCTAVES = 5;
+  static constexpr double LOWEST = 100;
+  PinkNoise::Default noise(1.0, SAMPLE_RATE / 20);
+  // Low-pass filters at the edges of each octave
+  FixedSizeIirCoefficientFilter<double, OCTAVES + 1, 4> lowPass[OCTAVES + 1];
+  double power[OCTAVES + 1];
+  for (size_t edge = 0; edge <= OCTAVES; edge++) {
+    auto coefficients = lowPass[edge].coefficients_.wrap();
+    Butterworth::create(coefficients, SAMPLE_RATE, LOWEST * (1 << edge),
+                        Butterworth::Pass::LOW, 1.0);
+    lowPass[edge].reset();
+    power[edge] = 0;
+  }
+  for (size_t i = 0; i < 20 * SAMPLE_RATE; i++) {
+    double x = noise();
+    for (size_t edge = 0; edge <= OCTAVES; edge++) {
+      double y = lowPass[edge].filter(0, x);
+      power[edge] += y * y;
+    }
+  }
+  double firstOctave = power[1] - power[0];
+  for (size_t octave = 2; octave <= OCTAVES; octave++) {
+    BOOST_CHECK_CLOSE(power[octave] - power[octave - 1], firstOctave, 25.0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
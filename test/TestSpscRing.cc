@@ -0,0 +1,78 @@
+/*
+ * speakerman/TestSpscRing.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <atomic>
+#include <memory>
+#include <tdap/SpscRing.hpp>
+#include <thread>
+
+using Ring = tdap::SpscRing<size_t, 16>;
+
+BOOST_AUTO_TEST_SUITE(testSpscRing)
+
+BOOST_AUTO_TEST_CASE(testPopsInOrderAndDropsWhenFull) {
+  Ring ring;
+  for (size_t i = 0; i < 20; i++) {
+    BOOST_CHECK_EQUAL(ring.push(i), i < 16);
+  }
+  BOOST_CHECK_EQUAL(ring.dropped(), 4);
+  size_t values[10];
+  BOOST_REQUIRE_EQUAL(ring.pop(values, 10), 10);
+  for (size_t i = 0; i < 10; i++) {
+    BOOST_CHECK_EQUAL(values[i], i);
+  }
+  BOOST_CHECK(ring.push(100));
+  BOOST_REQUIRE_EQUAL(ring.pop(values, 10), 7);
+  BOOST_CHECK_EQUAL(values[0], 10);
+  BOOST_CHECK_EQUAL(values[6], 100);
+  BOOST_CHECK_EQUAL(ring.pop(values, 10), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testNothingLostBetweenThreads) {
+  static constexpr size_t COUNT = 100000;
+  std::unique_ptr<Ring> ring(new Ring);
+  std::thread producer([&ring]() {
+    for (size_t i = 0; i < COUNT;) {
+      if (ring->push(i)) {
+        i++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  size_t expected = 0;
+  size_t values[5];
+  bool ordered = true;
+  while (expected < COUNT) {
+    size_t count = ring->pop(values, 5);
+    if (count == 0) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < count; i++, expected++) {
+      ordered &= values[i] == expected;
+    }
+  }
+  producer.join();
+  BOOST_CHECK(ordered);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
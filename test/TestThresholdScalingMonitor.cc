@@ -0,0 +1,67 @@
+/*
+ * speakerman/TestThresholdScalingMonitor.cc
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <speakerman/ThresholdScalingMonitor.h>
+
+using Monitor = speakerman::ThresholdScalingMonitor;
+
+namespace {
+
+const char *const RANGES = "# Parties\n"
+                           "  202610182000-202610190100: 3 birthday\n"
+                           "2026-10-20 10:00 - 2026-10-20T12:00 : 4\r\n"
+                           "2026-10-21_10:00-2026-10-21_12:00:6\n"
+                           "2026-10-22 10:00 - 2026-10-22 12:00 # : 2\n"
+                           "202610231000-202610231200: 2x\n";
+
+int scaling(long long now) { return Monitor::scalingForRanges(RANGES, now, 5); }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(testThresholdScalingMonitor)
+
+BOOST_AUTO_TEST_CASE(testRangeWithoutDashesIsInclusive) {
+  BOOST_CHECK_EQUAL(scaling(202610182000), 3);
+  BOOST_CHECK_EQUAL(scaling(202610190100), 3);
+  BOOST_CHECK_EQUAL(scaling(202610190101), Monitor::DEFAULT_SCALING);
+}
+
+BOOST_AUTO_TEST_CASE(testRangeWithDashes) {
+  BOOST_CHECK_EQUAL(scaling(202610201100), 4);
+}
+
+BOOST_AUTO_TEST_CASE(testScalingAboveMaximumIsIgnored) {
+  BOOST_CHECK_EQUAL(scaling(202610211100), Monitor::DEFAULT_SCALING);
+  BOOST_CHECK_EQUAL(Monitor::scalingForRanges(RANGES, 202610211100, 6), 6);
+}
+
+BOOST_AUTO_TEST_CASE(testCommentsAndMalformedLinesAreIgnored) {
+  BOOST_CHECK_EQUAL(scaling(202610221100), Monitor::DEFAULT_SCALING);
+  BOOST_CHECK_EQUAL(scaling(202610231100), Monitor::DEFAULT_SCALING);
+}
+
+BOOST_AUTO_TEST_CASE(testEmptyTextGivesDefault) {
+  BOOST_CHECK_EQUAL(Monitor::scalingForRanges("", 202610182000, 5),
+                    Monitor::DEFAULT_SCALING);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
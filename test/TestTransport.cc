@@ -0,0 +1,100 @@
+/*
+ * speakerman/TestTransport.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <atomic>
+#include <tdap/Transport.hpp>
+#include <thread>
+
+using namespace std::chrono;
+using Buffer = tdap::TripleBuffer<int>;
+using Transport = tdap::Transport<int>;
+
+BOOST_AUTO_TEST_SUITE(testTransport)
+
+BOOST_AUTO_TEST_CASE(testTripleBufferReturnsMostRecentValue) {
+  Buffer buffer;
+  BOOST_CHECK(!buffer.take());
+  for (int i = 1; i <= 3; i++) {
+    buffer.writeSlot() = i;
+    buffer.publish();
+  }
+  BOOST_REQUIRE(buffer.take());
+  BOOST_CHECK_EQUAL(buffer.readSlot(), 3);
+  BOOST_CHECK(!buffer.take());
+  BOOST_CHECK_EQUAL(buffer.readSlot(), 3);
+  buffer.writeSlot() = 4;
+  buffer.publish();
+  BOOST_REQUIRE(buffer.take());
+  BOOST_CHECK_EQUAL(buffer.readSlot(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(testCommandsAreAppliedWithoutWaitingForTheReader) {
+  Transport transport;
+  transport.put(1);
+  uint32_t sequence = transport.put(2);
+  BOOST_CHECK(!transport.awaitApplied(sequence, milliseconds(1)));
+  const int *command = transport.takeCommand();
+  BOOST_REQUIRE(command != nullptr);
+  BOOST_CHECK_EQUAL(*command, 2);
+  transport.applied();
+  BOOST_CHECK(transport.takeCommand() == nullptr);
+  BOOST_CHECK(transport.awaitApplied(sequence, milliseconds(0)));
+}
+
+BOOST_AUTO_TEST_CASE(testFillAndPutReusesSlotsAndReportsApplied) {
+  Transport transport;
+  for (int i = 1; i <= 3; i++) {
+    transport.put(i);
+    BOOST_REQUIRE(transport.takeCommand() != nullptr);
+    transport.applied();
+  }
+  // slots are reused round-robin, so this one was last written with 1
+  uint32_t sequence = transport.fillAndPut([](int &slot) { slot += 10; });
+  BOOST_CHECK(!transport.isApplied(sequence));
+  const int *command = transport.takeCommand();
+  BOOST_REQUIRE(command != nullptr);
+  BOOST_CHECK_EQUAL(*command, 11);
+  transport.applied();
+  BOOST_CHECK(transport.isApplied(sequence));
+  BOOST_CHECK(transport.isApplied(sequence - 1));
+}
+
+BOOST_AUTO_TEST_CASE(testWaiterIsWokenByLockFreeSide) {
+  Transport transport;
+  std::atomic<bool> stop = false;
+  std::thread lockFree([&transport, &stop]() {
+    while (!stop) {
+      if (transport.takeCommand()) {
+        transport.applied();
+      }
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+  });
+  for (int i = 0; i < 20; i++) {
+    uint32_t sequence = transport.put(i);
+    BOOST_CHECK(transport.awaitApplied(sequence, milliseconds(1000)));
+  }
+  stop = true;
+  lockFree.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
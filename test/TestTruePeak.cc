@@ -0,0 +1,75 @@
+/*
+ * speakerman/TestTruePeak.h
+ *
+ * Added by michel on 2026-10-18
+ * Copyright (C) 2015-2026 Michel Fleur.
+ * Source https://github.com/emmef/speakerman
+ * Email speakerman@emmef.org
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "boost-unit-tests.h"
+#include <cmath>
+#include <tdap/TruePeak.hpp>
+
+using Detector = tdap::TruePeakDetector<double, 2>;
+
+BOOST_AUTO_TEST_SUITE(testTruePeak)
+
+BOOST_AUTO_TEST_CASE(testPhasesHaveUnityDcGain) {
+  const auto &bank = tdap::TruePeakBank<double>::instance();
+  for (size_t p = 0; p < 4; p++) {
+    double sum = 0;
+    for (size_t tap = 0; tap < 12; tap++) {
+      sum += bank.phase[p][tap];
+    }
+    BOOST_CHECK_CLOSE(sum, 1.0, 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testImpulseIsDelayedByLatency) {
+  Detector detector;
+  for (size_t i = 0; i < 30; i++) {
+    double x = i == 3 ? 0.5 : 0.0;
+    detector.add(0, x);
+    detector.add(1, 0);
+    double peak = detector.next();
+    if (i == 3 + Detector::LATENCY) {
+      BOOST_CHECK_CLOSE(peak, 0.5, 1e-9);
+    } else if (i < 3) {
+      BOOST_CHECK_EQUAL(peak, 0.0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testInterSamplePeakOfQuarterRateSine) {
+  Detector detector;
+  double samplePeak = 0;
+  double truePeak = 0;
+  for (size_t i = 0; i < 200; i++) {
+    // All samples are at +/- sqrt(0.5), while the signal peaks at 1.
+    double x = sin(M_PI * i / 2 + M_PI / 4);
+    detector.add(0, 0.1 * x);
+    detector.add(1, x);
+    double peak = detector.next();
+    if (i > 2 * Detector::LATENCY) {
+      samplePeak = std::max(samplePeak, fabs(x));
+      truePeak = std::max(truePeak, peak);
+    }
+  }
+  BOOST_CHECK_CLOSE(samplePeak, M_SQRT1_2, 1e-6);
+  BOOST_CHECK_CLOSE(truePeak, 1.0, 2.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -638,10 +638,14 @@ function setMeters(levels) {
     }
 }
 
+// Sequence of the last level update, so the server merges what came after it
+var levelSequence = 0;
+
 function handleRequest() {
     if (xHttpRequest && xHttpRequest.status == 200) {
         if (RequestMetrics.enter(true)) {
             var levels = JSON.parse(xHttpRequest.responseText);
+            levelSequence = levels.sequence;
             setMeters(levels);
             RequestMetrics.release();
         }
@@ -656,7 +660,7 @@ function sendLevelRequest() {
         console.log("Postpone");
         return;
     }
-    var url = "/levels";
+    var url = "/levels?after=" + levelSequence;
     xHttpRequest = createCORSRequest('GET', url);
     try {
         xHttpRequest.onload = handleRequest;
@@ -677,3 +681,38 @@ function sendLevelRequest() {
     }
 }
 
+
+var levelStream = null;
+
+function startLevels() {
+    if (!window.WebSocket) {
+        sendLevelRequest();
+        return;
+    }
+    var protocol = window.location.protocol === "https:" ? "wss://" : "ws://";
+    var opened = false;
+    try {
+        levelStream = new WebSocket(protocol + window.location.host + "/levels/stream");
+    } catch (exception) {
+        console.log("Level stream unavailable: poll levels");
+        sendLevelRequest();
+        return;
+    }
+    levelStream.onopen = function () {
+        opened = true;
+        RequestMetrics.setConnectionMessage(true);
+    };
+    levelStream.onmessage = function (event) {
+        setMeters(JSON.parse(event.data));
+    };
+    levelStream.onclose = function () {
+        levelStream = null;
+        if (opened) {
+            RequestMetrics.setConnectionMessage(false);
+            window.setTimeout(startLevels, RequestMetrics.after_failure_period);
+        } else {
+            console.log("Level stream unavailable: poll levels");
+            sendLevelRequest();
+        }
+    };
+}